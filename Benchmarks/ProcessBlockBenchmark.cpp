@@ -0,0 +1,568 @@
+#include <JuceHeader.h>
+#include "VocalAIProPlugin.h"
+#include "AIPitchTuner.h"
+#include "VocalEffects.h"
+#include "AudioThreadGuard.h"
+#include "NonFiniteGuard.h"
+#include "FDNReverb.h"
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/**
+    Headless processBlock Benchmark
+
+    Runs a synthetic vocal through the plugin and each DSP module at several
+    sample rates and block sizes. Reports ns/sample, real-time factor and
+    the heap operations made on the audio thread. Exits non-zero if any
+    module allocated, so it doubles as a ctest real-time safety check.
+
+    Usage: VocalAIProBenchmark [--quick]
+*/
+
+//==============================================================================
+// C heap interposer (glibc). operator new/delete are counted by
+// AudioThreadGuard, which this target always builds with detection on.
+namespace
+{
+    std::atomic<std::uint64_t> realtimeMallocCount { 0 };
+
+    inline void countMallocIfRealtime() noexcept
+    {
+        if (AudioThreadGuard::isInRealtimeSection())
+            realtimeMallocCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#if defined(__GLIBC__)
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        countMallocIfRealtime();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        countMallocIfRealtime();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* memory, size_t size)
+    {
+        countMallocIfRealtime();
+        return __libc_realloc(memory, size);
+    }
+
+    void free(void* memory)
+    {
+        if (memory != nullptr)
+            countMallocIfRealtime();
+
+        __libc_free(memory);
+    }
+}
+ #define VOCALAI_BENCHMARK_COUNTS_MALLOC 1
+#else
+ #define VOCALAI_BENCHMARK_COUNTS_MALLOC 0
+#endif
+
+//==============================================================================
+// Sung vowel: a gliding, vibrato'd sawtooth through three formant resonators
+// with a syllable envelope and a little breath noise
+class VocalSignalGenerator
+{
+public:
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+
+        const float formantFrequencies[numFormants] = { 700.0f, 1220.0f, 2600.0f };
+        const float formantBandwidths[numFormants] = { 110.0f, 120.0f, 160.0f };
+
+        for (int i = 0; i < numFormants; ++i)
+        {
+            const double r = std::exp(-juce::MathConstants<double>::pi * formantBandwidths[i] / sampleRate);
+            formants[i].a1 = static_cast<float>(2.0 * r * std::cos(juce::MathConstants<double>::twoPi * formantFrequencies[i] / sampleRate));
+            formants[i].a2 = static_cast<float>(-r * r);
+            formants[i].gain = static_cast<float>(1.0 - r);
+            formants[i].y1 = formants[i].y2 = 0.0f;
+        }
+
+        phase = 0.0;
+        time = 0.0;
+        random.setSeed(0x5eed);
+    }
+
+    void fill(juce::AudioBuffer<float>& buffer)
+    {
+        const int numSamples = buffer.getNumSamples();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // 150-300 Hz glide every 4 s, 5.5 Hz vibrato of +/- 30 cents
+            const double glide = 0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * time / 4.0);
+            const double vibrato = std::pow(2.0, 0.3 / 12.0 * std::sin(juce::MathConstants<double>::twoPi * 5.5 * time));
+            const double f0 = 150.0 * std::pow(2.0, glide) * vibrato;
+
+            phase += f0 / sampleRate;
+            phase -= std::floor(phase);
+
+            const float source = static_cast<float>(2.0 * phase - 1.0) + 0.02f * (random.nextFloat() * 2.0f - 1.0f);
+
+            float voiced = 0.0f;
+            for (auto& formant : formants)
+            {
+                const float y = formant.gain * source + formant.a1 * formant.y1 + formant.a2 * formant.y2;
+                formant.y2 = formant.y1;
+                formant.y1 = y;
+                voiced += y;
+            }
+
+            // Three syllables per second with short gaps between them
+            const float envelope = static_cast<float>(juce::jmax(0.0, std::sin(juce::MathConstants<double>::pi * 3.0 * time)));
+            const float sample = 0.5f * voiced * envelope;
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.setSample(channel, i, channel == 0 ? sample : 0.9f * sample);
+
+            time += 1.0 / sampleRate;
+        }
+    }
+
+private:
+    static constexpr int numFormants = 3;
+
+    struct Resonator
+    {
+        float a1 = 0.0f, a2 = 0.0f, gain = 0.0f;
+        float y1 = 0.0f, y2 = 0.0f;
+    };
+
+    Resonator formants[numFormants];
+    double sampleRate = 44100.0;
+    double phase = 0.0;
+    double time = 0.0;
+    juce::Random random;
+};
+
+//==============================================================================
+struct ModuleResult
+{
+    double nanosecondsPerSample = 0.0;
+    double realTimeFactor = 0.0;   // Processing time / audio time
+    double worstBlockLoad = 0.0;   // Slowest block / block duration
+    std::uint64_t heapOperations = 0;
+    std::uint64_t mallocCalls = 0;
+};
+
+// Prepares, warms up, then times processBlockFunction over the whole input
+static ModuleResult runModule(VocalAIProPlugin& plugin, double sampleRate, int blockSize,
+                              const juce::AudioBuffer<float>& input,
+                              const std::function<void(juce::AudioBuffer<float>&, juce::MidiBuffer&)>& processBlockFunction)
+{
+    plugin.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> block(input.getNumChannels(), blockSize);
+    juce::MidiBuffer midi;
+    ModuleResult result;
+
+    const int numBlocks = input.getNumSamples() / blockSize;
+    const int warmUpBlocks = juce::jmin(numBlocks / 4, static_cast<int>(0.25 * sampleRate / blockSize) + 1);
+    const double blockSeconds = blockSize / sampleRate;
+
+    const auto heapOperationsBefore = AudioThreadGuard::getViolationCount();
+    const auto mallocCallsBefore = realtimeMallocCount.load();
+    juce::int64 measuredTicks = 0;
+
+    for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+    {
+        for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            block.copyFrom(channel, 0, input, channel, blockIndex * blockSize, blockSize);
+
+        midi.clear();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processBlockFunction(block, midi);
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+        if (blockIndex >= warmUpBlocks)
+        {
+            measuredTicks += elapsed;
+            result.worstBlockLoad = juce::jmax(result.worstBlockLoad,
+                                               juce::Time::highResolutionTicksToSeconds(elapsed) / blockSeconds);
+        }
+    }
+
+    // Allocations count from the first block; timing skips the warm-up
+    result.heapOperations = AudioThreadGuard::getViolationCount() - heapOperationsBefore;
+    result.mallocCalls = realtimeMallocCount.load() - mallocCallsBefore;
+
+    const double measuredSamples = static_cast<double>(numBlocks - warmUpBlocks) * blockSize;
+    const double measuredSeconds = juce::Time::highResolutionTicksToSeconds(measuredTicks);
+
+    if (measuredSamples > 0.0)
+    {
+        result.nanosecondsPerSample = measuredSeconds * 1.0e9 / measuredSamples;
+        result.realTimeFactor = measuredSeconds / (measuredSamples / sampleRate);
+    }
+
+    return result;
+}
+
+//==============================================================================
+// The per-sample std::isnan/std::isinf pre-scan processBlock used to run
+static bool legacyContainsNonFinite(const juce::AudioBuffer<float>& buffer)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        const float* channelData = buffer.getReadPointer(channel);
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        {
+            if (std::isnan(channelData[sample]) || std::isinf(channelData[sample]))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// ns/sample of a guard over clean input, block by block
+static double timeInputGuard(const juce::AudioBuffer<float>& input, int blockSize,
+                             const std::function<bool(juce::AudioBuffer<float>&)>& guard)
+{
+    juce::AudioBuffer<float> block(input.getNumChannels(), blockSize);
+    const int numBlocks = input.getNumSamples() / blockSize;
+    juce::int64 measuredTicks = 0;
+    int numFlagged = 0;
+
+    for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+    {
+        for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            block.copyFrom(channel, 0, input, channel, blockIndex * blockSize, blockSize);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        numFlagged += guard(block) ? 1 : 0;
+        measuredTicks += juce::Time::getHighResolutionTicks() - start;
+    }
+
+    jassert(numFlagged == 0); // Input is clean
+    juce::ignoreUnused(numFlagged);
+
+    return juce::Time::highResolutionTicksToSeconds(measuredTicks) * 1.0e9
+           / (static_cast<double>(numBlocks) * blockSize);
+}
+
+// ns/sample of a stereo effect processing the input in place, block by block
+static double timeStereoEffect(const juce::AudioBuffer<float>& input, int blockSize,
+                               const std::function<void(juce::AudioBuffer<float>&)>& effect)
+{
+    // As in processBlock, so decaying tails don't time denormal arithmetic
+    juce::ScopedNoDenormals noDenormals;
+    juce::AudioBuffer<float> block(input.getNumChannels(), blockSize);
+    const int numBlocks = input.getNumSamples() / blockSize;
+    juce::int64 measuredTicks = 0;
+
+    for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+    {
+        for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            block.copyFrom(channel, 0, input, channel, blockIndex * blockSize, blockSize);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        effect(block);
+        measuredTicks += juce::Time::getHighResolutionTicks() - start;
+    }
+
+    return juce::Time::highResolutionTicksToSeconds(measuredTicks) * 1.0e9
+           / (static_cast<double>(numBlocks) * blockSize);
+}
+
+// The O(lags x N) direct sum autocorrelationPitchDetection ran before the FFT
+static float legacyAutocorrelationPitch(AIPitchTuner& tuner, const float* samples, int numSamples, double sampleRate)
+{
+    const int minPeriod = static_cast<int>(sampleRate / 2000.0); // 2000 Hz max
+    const int maxPeriod = static_cast<int>(sampleRate / 80.0);   // 80 Hz min
+
+    float maxCorrelation = 0.0f;
+    int bestPeriod = 0;
+
+    for (int period = minPeriod; period < maxPeriod && period < numSamples / 2; ++period)
+    {
+        const float correlation = tuner.calculateAutocorrelation(samples, numSamples, period);
+
+        if (correlation > maxCorrelation)
+        {
+            maxCorrelation = correlation;
+            bestPeriod = period;
+        }
+    }
+
+    return bestPeriod > 0 && maxCorrelation > 0.1f ? static_cast<float>(sampleRate / bestPeriod) : 0.0f;
+}
+
+// ns/sample of running a detector once per tuner hop (10 ms) on a 40 ms
+// window, as the tuner does; also counts the hops where it found a pitch
+static double timePitchDetector(const juce::AudioBuffer<float>& input, double sampleRate, int& numVoiced,
+                                const std::function<float(const float*, int)>& detector)
+{
+    const int windowSize = static_cast<int>(sampleRate * 0.04);
+    const int hopSize = juce::jmax(1, static_cast<int>(sampleRate * 0.01));
+    const float* samples = input.getReadPointer(0);
+    juce::int64 measuredTicks = 0;
+    numVoiced = 0;
+
+    for (int start = 0; start + windowSize <= input.getNumSamples(); start += hopSize)
+    {
+        const auto begin = juce::Time::getHighResolutionTicks();
+        const float pitch = detector(samples + start, windowSize);
+        measuredTicks += juce::Time::getHighResolutionTicks() - begin;
+
+        numVoiced += pitch > 0.0f ? 1 : 0;
+    }
+
+    return juce::Time::highResolutionTicksToSeconds(measuredTicks) * 1.0e9 / input.getNumSamples();
+}
+
+// A note-on or note-off every 16 samples, cycling through 12 notes
+static void fillDenseMidi(juce::MidiBuffer& midi, int numSamples)
+{
+    static int noteCounter = 0;
+
+    for (int position = 0; position < numSamples; position += 16)
+    {
+        const int note = 60 + (noteCounter % 12);
+        const bool isNoteOn = (noteCounter / 12) % 2 == 0;
+
+        midi.addEvent(isNoteOn ? juce::MidiMessage::noteOn(1, note, 0.8f)
+                               : juce::MidiMessage::noteOff(1, note), position);
+        ++noteCounter;
+    }
+}
+
+static void setParameter(VocalAIProPlugin& plugin, const juce::String& parameterID, float plainValue)
+{
+    if (auto* parameter = plugin.getValueTreeState().getParameter(parameterID))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(plainValue));
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::StringArray arguments(argv + 1, argc - 1);
+    const bool quick = arguments.contains("--quick");
+
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const std::vector<int> blockSizes = quick ? std::vector<int> { 64, 512 }
+                                              : std::vector<int> { 32, 64, 128, 256, 512, 1024, 2048 };
+    const double secondsPerRun = quick ? 1.0 : 4.0;
+
+    // The benchmark reports heap use itself instead of stopping at the jassert
+    AudioThreadGuard::setAssertOnViolation(false);
+
+    std::printf("%-28s %8s %6s %10s %8s %8s %8s %8s\n",
+                "module", "rate", "block", "ns/sample", "RTF", "worst", "new/del", "malloc");
+
+    std::uint64_t totalHeapOperations = 0;
+
+    for (const double sampleRate : sampleRates)
+    {
+        juce::AudioBuffer<float> input(2, static_cast<int>(sampleRate * secondsPerRun));
+        VocalSignalGenerator generator;
+        generator.prepare(sampleRate);
+        generator.fill(input);
+
+        {
+            // Autocorrelation detector: per-lag direct sums vs one FFT pass. Independent
+            // of the block size, so the block column shows the 40 ms analysis window
+            AIPitchTuner tuner;
+            tuner.prepare(sampleRate, 512, 1);
+
+            int legacyVoiced = 0, fftVoiced = 0;
+            const double legacyCost = timePitchDetector(input, sampleRate, legacyVoiced, [&](const float* samples, int numSamples)
+                {
+                    return legacyAutocorrelationPitch(tuner, samples, numSamples, sampleRate);
+                });
+            const double fftCost = timePitchDetector(input, sampleRate, fftVoiced, [&](const float* samples, int numSamples)
+                {
+                    return tuner.autocorrelationPitchDetection(samples, numSamples);
+                });
+
+            const int windowSize = static_cast<int>(sampleRate * 0.04);
+            std::printf("%-28s %8.0f %6d %10.2f\n", "Autocorrelation (direct)", sampleRate, windowSize, legacyCost);
+            std::printf("%-28s %8.0f %6d %10.2f   %.1fx, voiced hops %d / %d\n", "Autocorrelation (FFT)", sampleRate, windowSize,
+                        fftCost, legacyCost / juce::jmax(fftCost, 1.0e-9), fftVoiced, legacyVoiced);
+        }
+
+        for (const int blockSize : blockSizes)
+        {
+            // Input NaN/Inf guard: old scalar scan vs the bit-mask reduction
+            NonFiniteGuard inputGuard;
+            inputGuard.prepare(sampleRate);
+
+            const double legacyGuardCost = timeInputGuard(input, blockSize, legacyContainsNonFinite);
+            const double guardCost = timeInputGuard(input, blockSize, [&](auto& buffer) { return inputGuard.process(buffer); });
+
+            std::printf("%-28s %8.0f %6d %10.2f\n", "Input guard (isnan/isinf)", sampleRate, blockSize, legacyGuardCost);
+            std::printf("%-28s %8.0f %6d %10.2f\n", "NonFiniteGuard", sampleRate, blockSize, guardCost);
+
+            // Reverb engines, fully wet at the same settings: Freeverb (8 combs +
+            // 4 all-passes per channel) vs the 8-line FDN
+            juce::Reverb freeverb;
+            juce::Reverb::Parameters freeverbParameters;
+            freeverbParameters.wetLevel = 1.0f;
+            freeverbParameters.dryLevel = 0.0f;
+            freeverb.setParameters(freeverbParameters);
+            freeverb.setSampleRate(sampleRate);
+
+            FDNReverb fdnReverb;
+            fdnReverb.prepare(sampleRate);
+
+            const double freeverbCost = timeStereoEffect(input, blockSize, [&](auto& buffer)
+                {
+                    freeverb.processStereo(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
+                });
+            const double fdnCost = timeStereoEffect(input, blockSize, [&](auto& buffer)
+                {
+                    fdnReverb.process(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples(), 1.0f, 0.0f);
+                });
+
+            std::printf("%-28s %8.0f %6d %10.2f\n", "Reverb (Freeverb)", sampleRate, blockSize, freeverbCost);
+            std::printf("%-28s %8.0f %6d %10.2f\n", "Reverb (FDN, 8 lines)", sampleRate, blockSize, fdnCost);
+
+            VocalAIProPlugin plugin;
+            plugin.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+
+            // Everything on, so every stage is exercised
+            setParameter(plugin, "pitchCorrection", 80.0f);
+            setParameter(plugin, "pitchSpeed", 50.0f);
+            setParameter(plugin, "pitchCorrectionEnabled", 1.0f);
+            setParameter(plugin, "reverbAmount", 30.0f);
+            setParameter(plugin, "delayTime", 250.0f);
+            setParameter(plugin, "delayFeedback", 30.0f);
+            setParameter(plugin, "harmonyAmount", 40.0f);
+            setParameter(plugin, "harmonyVoices", 3.0f);
+
+            auto* tuner = plugin.getAIPitchTuner();
+            auto* effects = plugin.getVocalEffects();
+
+            struct Module
+            {
+                const char* name;
+                std::function<void(juce::AudioBuffer<float>&, juce::MidiBuffer&)> process;
+            };
+
+            const Module modules[] = {
+                { "VocalAIProPlugin", [&](auto& buffer, auto& midi) { plugin.processBlock(buffer, midi); } },
+                { "AIPitchTuner (YIN)", [&](auto& buffer, auto& midi)
+                    {
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        tuner->setDetectionAlgorithm(AIPitchTuner::PitchDetectionAlgorithm::YIN);
+                        tuner->processBlock(buffer, midi);
+                    } },
+                { "AIPitchTuner (ACF)", [&](auto& buffer, auto& midi)
+                    {
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        tuner->setDetectionAlgorithm(AIPitchTuner::PitchDetectionAlgorithm::Autocorrelation);
+                        tuner->processBlock(buffer, midi);
+                    } },
+                { "AIPitchTuner (PSOLA)", [&](auto& buffer, auto& midi)
+                    {
+                        // Tracking engine; prepareToPlay restores the vocoder for the next row
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        tuner->setDetectionAlgorithm(AIPitchTuner::PitchDetectionAlgorithm::YIN);
+                        tuner->setPitchShiftEngine(AIPitchTuner::PitchShiftEngine::PSOLA);
+                        tuner->processBlock(buffer, midi);
+                    } },
+                { "AIPitchTuner (bypassed)", [&](auto& buffer, auto&)
+                    {
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        tuner->processBypassed(buffer);
+                    } },
+                { "VocalEffects", [&](auto& buffer, auto& midi)
+                    {
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        effects->processBlock(buffer, midi);
+                    } },
+                { "VocalEffects (8 harmonies)", [&](auto& buffer, auto& midi)
+                    {
+                        // Worst case for the harmony engine: cost should be ~linear in voices
+                        effects->setHarmonyVoices(8);
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        effects->processBlock(buffer, midi);
+                    } },
+                { "VocalAIProPlugin (MIDI)", [&](auto& buffer, auto& midi)
+                    {
+                        // Dense chords: more notes than voices, so stealing is exercised
+                        setParameter(plugin, "midiMode", 1.0f);
+                        fillDenseMidi(midi, buffer.getNumSamples());
+                        plugin.processBlock(buffer, midi);
+                    } },
+                { "VocalEffects (4-tap doubler)", [&](auto& buffer, auto& midi)
+                    {
+                        // Stereo doubling reads one shared history for all taps
+                        effects->setHarmonyVoices(1);
+                        effects->setDoublingTaps(4);
+                        effects->setDoublingAmount(0.5f);
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        effects->processBlock(buffer, midi);
+                    } },
+                { "Compressor (5 ms look-ahead)", [&](auto& buffer, auto&)
+                    {
+                        // Linked stereo detector, compressing the sung vowel hard
+                        effects->setCompressorThreshold(-30.0f);
+                        effects->setCompressorLookAhead(5.0f);
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        effects->applyCompression(buffer);
+                    } },
+                { "Dynamic EQ (4 bands)", [&](auto& buffer, auto&)
+                    {
+                        // Every band active so the neutral shortcut never fires
+                        effects->setDynamicEQBand(0, 150.0f, 2.0f, -30.0f, -6.0f);
+                        effects->setDynamicEQBand(1, 600.0f, -2.0f, -30.0f, -6.0f);
+                        effects->setDynamicEQBand(2, 2500.0f, 3.0f, -24.0f, -9.0f);
+                        effects->setDynamicEQBand(3, 7500.0f, 0.0f, -36.0f, -12.0f);
+                        juce::ScopedNoDenormals noDenormals; // As in processBlock; the gaps leave decaying SVF state
+                        AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+                        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                            effects->applyDynamicEQ(channel, buffer.getWritePointer(channel), buffer.getNumSamples());
+                    } }
+            };
+
+            for (const auto& module : modules)
+            {
+                const auto result = runModule(plugin, sampleRate, blockSize, input, module.process);
+
+                char mallocText[32] = "n/a";
+                if (VOCALAI_BENCHMARK_COUNTS_MALLOC)
+                    std::snprintf(mallocText, sizeof(mallocText), "%llu", static_cast<unsigned long long>(result.mallocCalls));
+
+                std::printf("%-28s %8.0f %6d %10.1f %8.4f %7.1f%% %8llu %8s\n",
+                            module.name, sampleRate, blockSize,
+                            result.nanosecondsPerSample, result.realTimeFactor, result.worstBlockLoad * 100.0,
+                            static_cast<unsigned long long>(result.heapOperations), mallocText);
+
+                totalHeapOperations += result.heapOperations + result.mallocCalls;
+            }
+        }
+    }
+
+    if (totalHeapOperations > 0)
+    {
+        std::printf("\nFAILED: %llu heap operations on the audio thread\n",
+                    static_cast<unsigned long long>(totalHeapOperations));
+        return 1;
+    }
+
+    std::printf("\nOK: no heap operations on the audio thread\n");
+    return 0;
+}
@@ -4,30 +4,104 @@
 AIPitchTuner::AIPitchTuner()
 {
     // Initialize buffers
-    pitchBuffer.resize(pitchBufferSize, 0.0f);
+    analysisFrame.resize(pitchBufferSize, 0.0f);
     autocorrelationBuffer.resize(pitchBufferSize, 0.0f);
     yinBuffer.resize(pitchBufferSize, 0.0f);
-    pitchShiftBuffer.resize(pitchShiftBufferSize, 0.0f);
-    overlapBuffer.resize(hopSize, 0.0f);
     fftBuffer.resize(fftSize * 2, 0.0f); // Complex FFT buffer
     windowBuffer.resize(fftSize, 0.0f);
+    analysisMagnitude.resize(fftSize / 2 + 1, 0.0f);
+    analysisFrequency.resize(fftSize / 2 + 1, 0.0f);
+    synthesisMagnitude.resize(fftSize / 2 + 1, 0.0f);
+    synthesisFrequency.resize(fftSize / 2 + 1, 0.0f);
     tempBuffer.resize(fftSize, 0.0f); // Temporary buffer for processing
+    prepareAutocorrelationEngine();
     
-    // Initialize Hann window
+    pitchShiftFFT = &fftPlans.prepare(static_cast<int>(std::log2(fftSize)));
+    formantShifter.prepare(*pitchShiftFFT);
+    fftPlans.prepare(spectralFeatureOrder);
+    scratchArena.prepare(static_cast<size_t>(4 << spectralFeatureOrder));
+    stftHopSize = fftSize / 4;
+    
+    // Initialize periodic Hann window (sums to a constant at 75% overlap)
+    float windowPowerSum = 0.0f;
     for (int i = 0; i < fftSize; ++i)
     {
-        windowBuffer[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / (fftSize - 1)));
+        windowBuffer[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / fftSize));
+        windowPowerSum += windowBuffer[i] * windowBuffer[i];
     }
     
-    // Initialize smoothers
-    pitchRatioSmoother.reset(0.0f);
-    pitchSmoother.reset(0.0f);
+    // Window applied twice (analysis + synthesis); overlapping frames sum to
+    // windowPowerSum / hop, so scale each frame back to unity gain
+    overlapAddGain = static_cast<float>(stftHopSize) / windowPowerSum;
+    
+    // Symmetric Hann for the PSOLA grains: halves offset by half a grain sum to one
+    for (int i = 0; i <= grainWindowSize; ++i)
+        grainWindow[static_cast<size_t>(i)] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / grainWindowSize));
 }
 
 AIPitchTuner::~AIPitchTuner()
 {
 }
 
+//==============================================================================
+void AIPitchTuner::ChannelVoice::prepare(int analysisSize, int stftSize, int stftHop, int psolaHistorySize, int smoothingSteps)
+{
+    pitchBuffer.assign(analysisSize, 0.0f);
+    inputFifo.assign(stftSize, 0.0f);
+    outputAccumulator.assign(stftSize, 0.0f);
+    lastPhase.assign(stftSize / 2 + 1, 0.0f);
+    sumPhase.assign(stftSize / 2 + 1, 0.0f);
+    psolaHistory.assign(psolaHistorySize, 0.0f);
+    psolaMask = psolaHistorySize - 1;
+    
+    // Fixed hop; the first frame fires once a full hop has been buffered
+    frameHopSize = stftHop;
+    
+    pitchRatioSmoother.reset(smoothingSteps);
+    pitchSmoother.reset(smoothingSteps);
+    
+    reset();
+}
+
+void AIPitchTuner::ChannelVoice::reset()
+{
+    currentHopPosition = 0;
+    samplesSinceLastAnalysis = 0;
+    numBufferedSamples = 0;
+    runningEnergy = 0.0;
+    
+    currentPitch = 0.0f;
+    pitchConfidence = 0.0f;
+    pitchDetected = false;
+    targetPitchRatio = 1.0f;
+    currentPitchRatio = 1.0f;
+    
+    pitchRatioSmoother.setCurrentAndTargetValue(1.0f);
+    pitchSmoother.setCurrentAndTargetValue(0.0f);
+    
+    std::fill(pitchBuffer.begin(), pitchBuffer.end(), 0.0f);
+    
+    resetShifters();
+}
+
+void AIPitchTuner::ChannelVoice::resetShifters()
+{
+    fifoPosition = 0;
+    samplesUntilNextFrame = frameHopSize;
+    
+    std::fill(inputFifo.begin(), inputFifo.end(), 0.0f);
+    std::fill(outputAccumulator.begin(), outputAccumulator.end(), 0.0f);
+    std::fill(lastPhase.begin(), lastPhase.end(), 0.0f);
+    std::fill(sumPhase.begin(), sumPhase.end(), 0.0f);
+    
+    psolaTime = 0;
+    lastPitchMark = 0;
+    samplesUntilNextGrain = 0;
+    grains.fill(Grain());
+    
+    std::fill(psolaHistory.begin(), psolaHistory.end(), 0.0f);
+}
+
 //==============================================================================
 void AIPitchTuner::prepare(double newSampleRate, int newBlockSize, int newNumChannels)
 {
@@ -36,27 +110,31 @@ void AIPitchTuner::prepare(double newSampleRate, int newBlockSize, int newNumCha
     numChannels = newNumChannels;
     
     // Resize buffers based on sample rate
-    pitchBufferSize = static_cast<int>(sampleRate * 0.1); // 100ms buffer
-    hopSize = static_cast<int>(sampleRate * 0.01); // 10ms hop
+    // 40ms window holds three periods of the lowest tracked pitch (80 Hz);
+    // it slides forward by one 10ms hop per analysis
+    pitchBufferSize = static_cast<int>(sampleRate * 0.04);
+    hopSize = juce::jmax(1, static_cast<int>(sampleRate * 0.01));
     
-    pitchBuffer.resize(pitchBufferSize, 0.0f);
+    analysisFrame.assign(pitchBufferSize, 0.0f);
     autocorrelationBuffer.resize(pitchBufferSize, 0.0f);
     yinBuffer.resize(pitchBufferSize, 0.0f);
-    overlapBuffer.resize(hopSize, 0.0f);
+    prepareAutocorrelationEngine();
     
-    // Reset processing state
-    currentHopPosition = 0;
+    // PSOLA grains reach back at most two periods of the lowest tracked
+    // pitch; the history also covers the quarter-period mark search
+    maxPitchPeriod = static_cast<int>(std::ceil(sampleRate / 80.0));
+    unvoicedPeriod = juce::jmax(2, static_cast<int>(sampleRate * 0.005));
+    const int psolaHistorySize = juce::nextPowerOfTwo(maxPitchPeriod * 4);
+    
+    // One independent voice per channel
+    voices.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+    for (auto& voice : voices)
+        voice.prepare(pitchBufferSize, fftSize, stftHopSize, psolaHistorySize, getPitchSmoothingSteps());
+    
+    // Reset reported state
     currentPitch = 0.0f;
     pitchConfidence = 0.0f;
     pitchDetected = false;
-    currentPitchRatio = 1.0f;
-    targetPitchRatio = 1.0f;
-    
-    // Configure smoothers
-    pitchRatioSmoother.reset(1.0f);
-    pitchSmoother.reset(0.0f);
-    pitchRatioSmoother.setCurrentAndTargetValue(1.0f);
-    pitchSmoother.setCurrentAndTargetValue(0.0f);
     
     isPrepared = true;
 }
@@ -65,81 +143,161 @@ void AIPitchTuner::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuff
 {
     if (!isPrepared) return;
     
-    juce::ignoreUnused(midiMessages);
-    
     const int numSamples = buffer.getNumSamples();
-    const int numChannelsToProcess = juce::jmin(numChannels, buffer.getNumChannels());
+    const int numChannelsToProcess = juce::jmin(numChannels, buffer.getNumChannels(), static_cast<int>(voices.size()));
     
-    // Process each channel
-    for (int channel = 0; channel < numChannelsToProcess; ++channel)
+    // In MIDI mode split the block at each event, so a note-on retargets
+    // the correction at its exact sample. Events at the same position
+    // share one split; work is bounded by the number of events.
+    int segmentStart = 0;
+    
+    if (midiTargetMode)
     {
-        float* channelData = buffer.getWritePointer(channel);
-        
-        // Fill pitch detection buffer
-        for (int sample = 0; sample < numSamples; ++sample)
+        for (const auto metadata : midiMessages)
         {
-            pitchBuffer[currentHopPosition] = channelData[sample];
-            currentHopPosition = (currentHopPosition + 1) % pitchBufferSize;
+            const int eventPosition = juce::jlimit(segmentStart, numSamples, metadata.samplePosition);
             
-            // Perform pitch detection when buffer is full
-            if (currentHopPosition == 0)
+            if (eventPosition > segmentStart)
             {
-                float detectedPitch = detectPitch(pitchBuffer.data(), pitchBufferSize);
-                
-                if (detectedPitch > 0.0f && isInRange(detectedPitch))
-                {
-                    currentPitch = detectedPitch;
-                    pitchDetected = true;
-                    pitchConfidence = 0.8f; // Simplified confidence calculation
-                    
-                    // Calculate target pitch and pitch ratio
-                    float targetPitch = calculateTargetPitch(detectedPitch);
-                    targetPitchRatio = targetPitch / detectedPitch;
-                }
-                else
-                {
-                    pitchDetected = false;
-                    pitchConfidence = 0.0f;
-                    targetPitchRatio = 1.0f;
-                }
+                processSegment(buffer, segmentStart, eventPosition - segmentStart, numChannelsToProcess);
+                segmentStart = eventPosition;
             }
+            
+            heldNotes.handleMidiEvent(metadata.getMessage());
+            retargetVoices();
         }
+    }
+    
+    if (segmentStart < numSamples)
+        processSegment(buffer, segmentStart, numSamples - segmentStart, numChannelsToProcess);
+    
+    // Report the first (or linked) voice to the UI
+    if (numChannelsToProcess > 0)
+    {
+        currentPitch = voices[0].currentPitch;
+        pitchConfidence = voices[0].pitchConfidence;
+        pitchDetected = isAnalysing() && voices[0].pitchDetected;
+    }
+}
+
+void AIPitchTuner::processSegment(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int numChannelsToProcess)
+{
+    const bool useLinkedStereo = linkedStereo && numChannelsToProcess > 1;
+    
+    // Slide the analysis windows: once on the mid signal when linked,
+    // otherwise once per channel. Analysis also runs with correction off
+    // when downstream harmony needs the pitch.
+    if (isAnalysing())
+    {
+        if (useLinkedStereo)
+        {
+            analyseSamples(voices[0], buffer.getReadPointer(0, startSample), buffer.getReadPointer(1, startSample), numSamples);
+        }
+        else
+        {
+            for (int channel = 0; channel < numChannelsToProcess; ++channel)
+                analyseSamples(voices[static_cast<size_t>(channel)], buffer.getReadPointer(channel, startSample), nullptr, numSamples);
+        }
+    }
+    
+    // Shift every channel through its own streaming vocoder. The vocoder
+    // always runs so the output latency never changes; without a usable
+    // pitch the ratio simply glides back to 1.
+    for (int channel = 0; channel < numChannelsToProcess; ++channel)
+    {
+        auto& voice = voices[static_cast<size_t>(channel)];
+        const auto& analysis = useLinkedStereo ? voices[0] : voice;
         
-        // Apply pitch correction if enabled
-        if (pitchDetected && pitchCorrectionStrength > 0.0f)
+        const bool shouldCorrect = correctionEnabled && analysis.pitchDetected && pitchCorrectionStrength > 0.0f;
+        processPitchShift(voice, analysis, buffer.getWritePointer(channel, startSample), numSamples,
+                          shouldCorrect ? analysis.targetPitchRatio : 1.0f,
+                          correctionEnabled ? formantShiftRatio : 1.0f);
+    }
+}
+
+void AIPitchTuner::retargetVoices()
+{
+    // New held notes apply to the current estimate immediately, not at the next hop
+    for (auto& voice : voices)
+    {
+        if (voice.pitchDetected && voice.currentPitch > 0.0f)
+            voice.targetPitchRatio = calculateTargetPitch(voice.currentPitch) / voice.currentPitch;
+    }
+}
+
+void AIPitchTuner::processBypassed(juce::AudioBuffer<float>& buffer)
+{
+    if (!isPrepared) return;
+    
+    const int numChannelsToProcess = juce::jmin(numChannels, buffer.getNumChannels(), static_cast<int>(voices.size()));
+    
+    // PSOLA has no latency to match; keep its history current so the
+    // first grains after bypass read the live signal
+    if (shiftEngine == PitchShiftEngine::PSOLA)
+    {
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
         {
-            // Smooth pitch ratio changes
-            pitchRatioSmoother.setTargetValue(targetPitchRatio);
-            currentPitchRatio = pitchRatioSmoother.getNextValue();
+            auto& voice = voices[static_cast<size_t>(channel)];
+            const float* samples = buffer.getReadPointer(channel);
             
-            // Apply pitch shifting
-            if (std::abs(currentPitchRatio - 1.0f) > 0.01f)
-            {
-                processPitchShift(buffer, channel, currentPitchRatio);
-            }
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                voice.psolaHistory[static_cast<size_t>(voice.psolaTime++ & voice.psolaMask)] = samples[i];
         }
+        
+        return;
     }
+    
+    // Same FIFOs at unity ratio: delays by exactly getLatencySamples()
+    for (int channel = 0; channel < numChannelsToProcess; ++channel)
+    {
+        auto& voice = voices[static_cast<size_t>(channel)];
+        processPitchShift(voice, voice, buffer.getWritePointer(channel), buffer.getNumSamples(), 1.0f, 1.0f);
+    }
+}
+
+float AIPitchTuner::getDetectedPitch(int channel) const
+{
+    if (channel < 0 || channel >= static_cast<int>(voices.size()))
+        return 0.0f;
+    
+    // Linked stereo analyses once, on the mid signal
+    const auto& analysis = linkedStereo && voices.size() > 1 ? voices[0] : voices[static_cast<size_t>(channel)];
+    
+    if (! isAnalysing() || ! analysis.pitchDetected)
+        return 0.0f;
+    
+    return analysis.currentPitch;
+}
+
+float AIPitchTuner::getOutputPitch(int channel) const
+{
+    // With correction off the ratio glides back to 1, so this follows the input
+    const float detected = getDetectedPitch(channel);
+    
+    if (detected <= 0.0f)
+        return 0.0f;
+    
+    return detected * voices[static_cast<size_t>(channel)].currentPitchRatio;
 }
 
 void AIPitchTuner::reset()
 {
-    currentHopPosition = 0;
     currentPitch = 0.0f;
     pitchConfidence = 0.0f;
     pitchDetected = false;
-    currentPitchRatio = 1.0f;
-    targetPitchRatio = 1.0f;
     
     // Clear buffers
-    std::fill(pitchBuffer.begin(), pitchBuffer.end(), 0.0f);
+    for (auto& voice : voices)
+        voice.reset();
+    
+    heldNotes.allNotesOff();
+    
+    std::fill(analysisFrame.begin(), analysisFrame.end(), 0.0f);
     std::fill(autocorrelationBuffer.begin(), autocorrelationBuffer.end(), 0.0f);
     std::fill(yinBuffer.begin(), yinBuffer.end(), 0.0f);
-    std::fill(pitchShiftBuffer.begin(), pitchShiftBuffer.end(), 0.0f);
-    std::fill(overlapBuffer.begin(), overlapBuffer.end(), 0.0f);
-    
-    // Reset smoothers
-    pitchRatioSmoother.reset(1.0f);
-    pitchSmoother.reset(0.0f);
+    std::fill(autocorrelationFFTBuffer.begin(), autocorrelationFFTBuffer.end(), 0.0f);
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    formantShifter.reset();
 }
 
 //==============================================================================
@@ -150,11 +308,24 @@ void AIPitchTuner::setPitchCorrection(float strength)
 
 void AIPitchTuner::setPitchSpeed(float speed)
 {
-    pitchSpeed = juce::jlimit(0.0f, 1.0f, speed);
+    speed = juce::jlimit(0.0f, 1.0f, speed);
+    
+    // Called every block; only re-time the smoothers on an actual change,
+    // since reset() also snaps them to their target
+    if (speed == pitchSpeed)
+        return;
+    
+    pitchSpeed = speed;
     
     // Adjust smoother speed based on pitch speed parameter
-    float smootherTime = 0.1f * (1.0f - speed) + 0.001f; // 1ms to 100ms
-    pitchRatioSmoother.reset(smootherTime * sampleRate);
+    for (auto& voice : voices)
+        voice.pitchRatioSmoother.reset(getPitchSmoothingSteps());
+}
+
+int AIPitchTuner::getPitchSmoothingSteps() const
+{
+    float smootherTime = 0.1f * (1.0f - pitchSpeed) + 0.001f; // 1ms to 100ms
+    return juce::jmax(1, static_cast<int>(smootherTime * sampleRate));
 }
 
 void AIPitchTuner::setKeyCenter(float frequency)
@@ -167,11 +338,151 @@ void AIPitchTuner::setScaleMode(int mode)
     scaleMode = juce::jlimit(0, 7, mode);
 }
 
+void AIPitchTuner::setDetectionAlgorithm(PitchDetectionAlgorithm algorithm)
+{
+    detectionAlgorithm = algorithm;
+}
+
+void AIPitchTuner::setYinThreshold(float threshold)
+{
+    yinThreshold = juce::jlimit(0.01f, 0.5f, threshold);
+}
+
+void AIPitchTuner::setLinkedStereo(bool shouldLink)
+{
+    linkedStereo = shouldLink;
+}
+
+void AIPitchTuner::setCorrectionEnabled(bool shouldCorrect)
+{
+    correctionEnabled = shouldCorrect;
+}
+
+void AIPitchTuner::setAnalysisEnabled(bool shouldAnalyse)
+{
+    analysisEnabled = shouldAnalyse;
+}
+
+void AIPitchTuner::setMidiTargetMode(bool shouldUseMidi)
+{
+    if (shouldUseMidi != midiTargetMode)
+        heldNotes.allNotesOff();
+    
+    midiTargetMode = shouldUseMidi;
+}
+
+void AIPitchTuner::setFormantPreservation(bool shouldPreserve)
+{
+    formantPreservation = shouldPreserve;
+}
+
+void AIPitchTuner::setFormantShift(float semitones)
+{
+    formantShiftRatio = std::exp2(juce::jlimit(-12.0f, 12.0f, semitones) / 12.0f);
+}
+
+void AIPitchTuner::setPitchShiftEngine(PitchShiftEngine engine)
+{
+    if (engine == shiftEngine)
+        return;
+    
+    shiftEngine = engine;
+    
+    // Neither engine's buffers hold anything the other can continue from
+    for (auto& voice : voices)
+        voice.resetShifters();
+}
+
+//==============================================================================
+void AIPitchTuner::analyseSamples(ChannelVoice& voice, const float* left, const float* right, int numSamples)
+{
+    // Slide the analysis window and run a detection every hop.
+    // With a right channel the window receives the mid signal.
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        const float input = right != nullptr ? 0.5f * (left[sample] + right[sample]) : left[sample];
+        pushAnalysisSample(voice, input);
+        
+        if (++voice.samplesSinceLastAnalysis >= hopSize)
+        {
+            voice.samplesSinceLastAnalysis = 0;
+            runHopAnalysis(voice);
+        }
+    }
+}
+
+void AIPitchTuner::pushAnalysisSample(ChannelVoice& voice, float sample)
+{
+    // Keep the window energy current without rescanning the ring
+    const float outgoing = voice.pitchBuffer[voice.currentHopPosition];
+    voice.runningEnergy += static_cast<double>(sample) * sample - static_cast<double>(outgoing) * outgoing;
+    
+    voice.pitchBuffer[voice.currentHopPosition] = sample;
+    
+    if (++voice.currentHopPosition == pitchBufferSize)
+        voice.currentHopPosition = 0;
+    
+    if (voice.numBufferedSamples < pitchBufferSize)
+        ++voice.numBufferedSamples;
+}
+
+void AIPitchTuner::runHopAnalysis(ChannelVoice& voice)
+{
+    // Wait for one full window before the first estimate
+    if (voice.numBufferedSamples < pitchBufferSize)
+        return;
+    
+    // Clamp accumulated rounding error; the sum can never be negative
+    voice.runningEnergy = juce::jmax(0.0, voice.runningEnergy);
+    
+    // Skip the detector entirely on silence
+    const float windowRMS = static_cast<float>(std::sqrt(voice.runningEnergy / pitchBufferSize));
+    if (windowRMS < analysisSilenceThreshold)
+    {
+        updatePitchEstimate(voice, 0.0f);
+        return;
+    }
+    
+    // Linearize the ring (oldest sample first) for the detectors
+    const int tailLength = pitchBufferSize - voice.currentHopPosition;
+    std::copy(voice.pitchBuffer.begin() + voice.currentHopPosition, voice.pitchBuffer.end(), analysisFrame.begin());
+    std::copy(voice.pitchBuffer.begin(), voice.pitchBuffer.begin() + voice.currentHopPosition, analysisFrame.begin() + tailLength);
+    
+    updatePitchEstimate(voice, detectPitch(analysisFrame.data(), pitchBufferSize));
+}
+
+void AIPitchTuner::updatePitchEstimate(ChannelVoice& voice, float detectedPitch)
+{
+    if (detectedPitch > 0.0f && isInRange(detectedPitch))
+    {
+        voice.currentPitch = detectedPitch;
+        voice.pitchDetected = true;
+        voice.pitchConfidence = lastDetectionConfidence;
+        
+        // Calculate target pitch and pitch ratio
+        float targetPitch = calculateTargetPitch(detectedPitch);
+        voice.targetPitchRatio = targetPitch / detectedPitch;
+    }
+    else
+    {
+        voice.pitchDetected = false;
+        voice.pitchConfidence = 0.0f;
+        voice.targetPitchRatio = 1.0f;
+    }
+}
+
 //==============================================================================
 float AIPitchTuner::detectPitch(const float* samples, int numSamples)
 {
-    // Use autocorrelation method for pitch detection
-    return autocorrelationPitchDetection(samples, numSamples);
+    switch (detectionAlgorithm)
+    {
+        case PitchDetectionAlgorithm::Autocorrelation:
+            return autocorrelationPitchDetection(samples, numSamples);
+            
+        case PitchDetectionAlgorithm::YIN:
+        default:
+            return yinPitchDetection(samples, numSamples);
+    }
 }
 
 float AIPitchTuner::autocorrelationPitchDetection(const float* samples, int numSamples)
@@ -180,79 +491,184 @@ float AIPitchTuner::autocorrelationPitchDetection(const float* samples, int numS
     const int minPeriod = static_cast<int>(sampleRate / 2000.0f); // 2000 Hz max
     const int maxPeriod = static_cast<int>(sampleRate / 80.0f);   // 80 Hz min
     
+    // All lags at once in O(N log N) instead of one O(N) pass per lag
+    const int numLags = computeAutocorrelation(samples, numSamples, maxPeriod);
+    const int analysedSamples = juce::jmin(numSamples, autocorrelationFFTSize / 2);
+    
     float maxCorrelation = 0.0f;
     int bestPeriod = 0;
     
-    for (int period = minPeriod; period < maxPeriod && period < numSamples / 2; ++period)
+    for (int period = minPeriod; period < maxPeriod && period < numLags && period < analysedSamples / 2; ++period)
     {
-        float correlation = 0.0f;
-        int count = 0;
-        
-        for (int i = 0; i < numSamples - period; ++i)
-        {
-            correlation += samples[i] * samples[i + period];
-            count++;
-        }
+        // Normalise by the overlap length, as the direct sum did
+        const float correlation = autocorrelationBuffer[period] / static_cast<float>(analysedSamples - period);
         
-        if (count > 0)
+        if (correlation > maxCorrelation)
         {
-            correlation /= count;
-            
-            if (correlation > maxCorrelation)
-            {
-                maxCorrelation = correlation;
-                bestPeriod = period;
-            }
+            maxCorrelation = correlation;
+            bestPeriod = period;
         }
     }
     
     if (bestPeriod > 0 && maxCorrelation > 0.1f) // Threshold for confidence
     {
+        lastDetectionConfidence = 0.8f; // Simplified confidence calculation
         return sampleRate / bestPeriod;
     }
     
+    lastDetectionConfidence = 0.0f;
     return 0.0f;
 }
 
 float AIPitchTuner::yinPitchDetection(const float* samples, int numSamples)
 {
-    // Simplified YIN algorithm implementation
-    const int minPeriod = static_cast<int>(sampleRate / 2000.0f);
-    const int maxPeriod = static_cast<int>(sampleRate / 80.0f);
+    // YIN (de Cheveigne & Kawahara, 2002) with the difference function
+    // computed via FFT:
+    //   d(tau) = E(0) + E(tau) - 2 r(tau)
+    // where E(t) is the energy of x[t .. t+W) taken from a prefix sum and
+    // r(tau) = sum_j x[j] x[j+tau] over the first W samples (one FFT
+    // cross-correlation). yinBuffer receives the cumulative mean
+    // normalized difference d'(tau) for tau <= maxPeriod.
+    lastDetectionConfidence = 0.0f;
+    
+    if (autocorrelationFFT == nullptr || samples == nullptr)
+        return 0.0f;
+    
+    jassert(numSamples <= autocorrelationFFTSize / 2);
+    numSamples = juce::jmin(numSamples, autocorrelationFFTSize / 2);
+    
+    const int minPeriod = juce::jmax(2, static_cast<int>(sampleRate / 2000.0f));
+    const int maxPeriod = juce::jmin(static_cast<int>(sampleRate / 80.0f),
+                                     static_cast<int>(yinBuffer.size()) - 2);
+    const int integrationLength = numSamples - maxPeriod - 1;
+    
+    if (integrationLength < minPeriod || maxPeriod <= minPeriod)
+        return 0.0f;
+    
+    // Cross term: conj(FFT(head)) * FFT(frame), one inverse transform
+    float* frameSpectrum = autocorrelationFFTBuffer.data();
+    float* headSpectrum = yinFFTBuffer.data();
+    
+    std::copy(samples, samples + numSamples, frameSpectrum);
+    std::fill(frameSpectrum + numSamples, frameSpectrum + autocorrelationFFTBuffer.size(), 0.0f);
+    std::copy(samples, samples + integrationLength, headSpectrum);
+    std::fill(headSpectrum + integrationLength, headSpectrum + yinFFTBuffer.size(), 0.0f);
+    
+    autocorrelationFFT->performRealOnlyForwardTransform(frameSpectrum, true);
+    autocorrelationFFT->performRealOnlyForwardTransform(headSpectrum, true);
+    
+    for (int k = 0; k <= autocorrelationFFTSize / 2; ++k)
+    {
+        const float fr = frameSpectrum[k * 2], fi = frameSpectrum[k * 2 + 1];
+        const float hr = headSpectrum[k * 2],  hi = headSpectrum[k * 2 + 1];
+        frameSpectrum[k * 2]     = hr * fr + hi * fi;
+        frameSpectrum[k * 2 + 1] = hr * fi - hi * fr;
+    }
     
-    // Calculate difference function
-    std::fill(yinBuffer.begin(), yinBuffer.end(), 0.0f);
+    autocorrelationFFT->performRealOnlyInverseTransform(frameSpectrum);
     
-    for (int tau = minPeriod; tau < maxPeriod && tau < numSamples / 2; ++tau)
+    // Energy terms from a prefix sum of squares
+    yinEnergyPrefix[0] = 0.0;
+    for (int i = 0; i < numSamples; ++i)
+        yinEnergyPrefix[i + 1] = yinEnergyPrefix[i] + static_cast<double>(samples[i]) * samples[i];
+    
+    const double headEnergy = yinEnergyPrefix[integrationLength];
+    
+    // Cumulative mean normalized difference
+    yinBuffer[0] = 1.0f;
+    double runningSum = 0.0;
+    
+    for (int tau = 1; tau <= maxPeriod + 1; ++tau)
     {
-        float sum = 0.0f;
-        for (int i = 0; i < numSamples - tau; ++i)
-        {
-            float diff = samples[i] - samples[i + tau];
-            sum += diff * diff;
-        }
-        yinBuffer[tau] = sum;
+        const double lagEnergy = yinEnergyPrefix[tau + integrationLength] - yinEnergyPrefix[tau];
+        const double difference = juce::jmax(0.0, headEnergy + lagEnergy - 2.0 * frameSpectrum[tau]);
+        
+        runningSum += difference;
+        yinBuffer[tau] = runningSum > 0.0 ? static_cast<float>(difference * tau / runningSum) : 1.0f;
     }
     
-    // Find minimum
-    float minValue = yinBuffer[minPeriod];
-    int minIndex = minPeriod;
+    // Absolute threshold: first dip below it, followed down to its local minimum
+    int bestTau = -1;
     
-    for (int i = minPeriod + 1; i < maxPeriod; ++i)
+    for (int tau = minPeriod; tau <= maxPeriod; ++tau)
     {
-        if (yinBuffer[i] < minValue)
+        if (yinBuffer[tau] < yinThreshold)
         {
-            minValue = yinBuffer[i];
-            minIndex = i;
+            while (tau + 1 <= maxPeriod && yinBuffer[tau + 1] < yinBuffer[tau])
+                ++tau;
+            
+            bestTau = tau;
+            break;
         }
     }
     
-    if (minValue < 0.1f && minIndex > 0) // Threshold
+    if (bestTau < 0)
+        return 0.0f; // Unvoiced / aperiodic
+    
+    // Parabolic interpolation around the minimum for sub-sample precision
+    const float s0 = yinBuffer[bestTau - 1];
+    const float s1 = yinBuffer[bestTau];
+    const float s2 = yinBuffer[bestTau + 1];
+    const float curvature = s0 - 2.0f * s1 + s2;
+    
+    float refinedTau = static_cast<float>(bestTau);
+    if (curvature > 0.0f)
+        refinedTau += juce::jlimit(-0.5f, 0.5f, 0.5f * (s0 - s2) / curvature);
+    
+    lastDetectionConfidence = juce::jlimit(0.0f, 1.0f, 1.0f - s1);
+    return static_cast<float>(sampleRate) / refinedTau;
+}
+
+//==============================================================================
+void AIPitchTuner::prepareAutocorrelationEngine()
+{
+    // Zero-pad to at least twice the analysis length so the circular
+    // correlation computed by the FFT never wraps into the lags we read
+    const int order = juce::jmax(1, static_cast<int>(std::ceil(std::log2(2.0 * pitchBufferSize))));
+    
+    autocorrelationFFT = &fftPlans.prepare(order);
+    autocorrelationFFTSize = autocorrelationFFT->getSize();
+    
+    // Real-only transforms need 2 * size floats of workspace
+    autocorrelationFFTBuffer.assign(static_cast<size_t>(autocorrelationFFTSize) * 2, 0.0f);
+    yinFFTBuffer.assign(static_cast<size_t>(autocorrelationFFTSize) * 2, 0.0f);
+    yinEnergyPrefix.assign(static_cast<size_t>(autocorrelationFFTSize / 2) + 1, 0.0);
+    autocorrelationBuffer.assign(static_cast<size_t>(juce::jmax(pitchBufferSize, autocorrelationFFTSize / 2)), 0.0f);
+}
+
+int AIPitchTuner::computeAutocorrelation(const float* samples, int numSamples, int maxLag)
+{
+    // Wiener-Khinchin: r[lag] = IFFT(|FFT(x)|^2)[lag] for zero-padded x.
+    // Writes un-normalised sums into autocorrelationBuffer[0..maxLag] and
+    // returns the number of valid lags.
+    if (autocorrelationFFT == nullptr || samples == nullptr || numSamples <= 0)
+        return 0;
+    
+    // Anything longer than the prepared window would alias; analyse its head
+    jassert(numSamples <= autocorrelationFFTSize / 2);
+    numSamples = juce::jmin(numSamples, autocorrelationFFTSize / 2);
+    
+    float* fftData = autocorrelationFFTBuffer.data();
+    std::copy(samples, samples + numSamples, fftData);
+    std::fill(fftData + numSamples, fftData + autocorrelationFFTBuffer.size(), 0.0f);
+    
+    autocorrelationFFT->performRealOnlyForwardTransform(fftData, true);
+    
+    // Power spectrum (non-negative bins only; the inverse mirrors the rest)
+    for (int k = 0; k <= autocorrelationFFTSize / 2; ++k)
     {
-        return sampleRate / minIndex;
+        const float re = fftData[k * 2];
+        const float im = fftData[k * 2 + 1];
+        fftData[k * 2] = re * re + im * im;
+        fftData[k * 2 + 1] = 0.0f;
     }
     
-    return 0.0f;
+    autocorrelationFFT->performRealOnlyInverseTransform(fftData);
+    
+    const int numLags = juce::jmin(maxLag + 1, numSamples, static_cast<int>(autocorrelationBuffer.size()));
+    std::copy(fftData, fftData + numLags, autocorrelationBuffer.begin());
+    
+    return numLags;
 }
 
 //==============================================================================
@@ -260,6 +676,17 @@ float AIPitchTuner::calculateTargetPitch(float detectedPitch)
 {
     if (detectedPitch <= 0.0f) return detectedPitch;
     
+    // MIDI mode: the held note is the target as played, no scale involved
+    if (midiTargetMode)
+    {
+        const int heldNote = heldNotes.getLatestNote();
+        if (heldNote < 0)
+            return detectedPitch;
+        
+        const float notePitch = midiToFrequency(static_cast<float>(heldNote));
+        return detectedPitch + (notePitch - detectedPitch) * pitchCorrectionStrength;
+    }
+    
     // Convert to MIDI note
     float midiNote = frequencyToMidi(detectedPitch);
     
@@ -283,140 +710,283 @@ float AIPitchTuner::calculateTargetPitch(float detectedPitch)
 
 void AIPitchTuner::applyPitchCorrection(juce::AudioBuffer<float>& buffer, int channel, float targetPitch)
 {
-    if (currentPitch <= 0.0f) return;
+    if (channel < 0 || channel >= static_cast<int>(voices.size())) return;
     
-    float pitchRatio = targetPitch / currentPitch;
-    processPitchShift(buffer, channel, pitchRatio);
+    auto& voice = voices[static_cast<size_t>(channel)];
+    if (voice.currentPitch <= 0.0f) return;
+    
+    float pitchRatio = targetPitch / voice.currentPitch;
+    processPitchShift(voice, voice, buffer.getWritePointer(channel), buffer.getNumSamples(), pitchRatio, formantShiftRatio);
 }
 
 //==============================================================================
-void AIPitchTuner::pitchShift(float* samples, int numSamples, float pitchRatio)
+void AIPitchTuner::processPitchShift(ChannelVoice& voice, const ChannelVoice& analysis, float* samples, int numSamples,
+                                     float pitchRatio, float formantRatio)
+{
+    // Ratio changes glide per sample; frames and grains pick up the current value
+    voice.pitchRatioSmoother.setTargetValue(pitchRatio);
+    
+    if (shiftEngine == PitchShiftEngine::PSOLA)
+        processPitchShiftPSOLA(voice, analysis, samples, numSamples);
+    else
+        processPitchShiftFFT(voice, analysis, samples, numSamples, formantRatio);
+}
+
+void AIPitchTuner::processPitchShiftFFT(ChannelVoice& voice, const ChannelVoice& analysis, float* samples, int numSamples, float formantRatio)
+{
+    // Streaming STFT: every input sample enters the FIFO and every output
+    // sample leaves the overlap-add accumulator, so any host block size
+    // (including 1 sample) works. A frame is analysed/resynthesised every
+    // stftHopSize samples; output lags input by exactly fftSize samples.
+    if (numSamples <= 0 || samples == nullptr || pitchShiftFFT == nullptr)
+        return;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        voice.currentPitchRatio = voice.pitchRatioSmoother.getNextValue();
+        
+        const int position = voice.fifoPosition;
+        voice.inputFifo[position] = samples[i];
+        samples[i] = voice.outputAccumulator[position];
+        voice.outputAccumulator[position] = 0.0f;
+        
+        if (++voice.fifoPosition == fftSize)
+            voice.fifoPosition = 0;
+        
+        if (--voice.samplesUntilNextFrame <= 0)
+        {
+            voice.samplesUntilNextFrame = stftHopSize;
+            processPhaseVocoderFrame(voice, analysis, voice.currentPitchRatio, formantRatio);
+        }
+    }
+}
+
+void AIPitchTuner::processPhaseVocoderFrame(ChannelVoice& voice, const ChannelVoice& analysis, float pitchRatio, float formantRatio)
 {
-    // Simple pitch shifting using phase vocoder technique
-    // This is a simplified implementation - production code would use more sophisticated algorithms
+    constexpr float twoPi = 2.0f * juce::MathConstants<float>::pi;
+    const int numBins = fftSize / 2 + 1;
+    const float expectedPhaseAdvance = twoPi * static_cast<float>(stftHopSize) / static_cast<float>(fftSize);
     
-    if (std::abs(pitchRatio - 1.0f) < 0.01f) return;
+    // Window the last fftSize input samples (oldest first)
+    float* frame = fftBuffer.data();
+    for (int i = 0; i < fftSize; ++i)
+    {
+        int index = voice.fifoPosition + i;
+        if (index >= fftSize)
+            index -= fftSize;
+        
+        frame[i] = voice.inputFifo[index] * windowBuffer[i];
+    }
+    std::fill(frame + fftSize, frame + fftSize * 2, 0.0f);
     
-    // For now, use a simple time-stretching approach
-    // In a real implementation, you'd use FFT-based phase vocoder or PSOLA
+    pitchShiftFFT->performRealOnlyForwardTransform(frame, true);
     
-    std::vector<float> tempBuffer(numSamples);
-    std::copy(samples, samples + numSamples, tempBuffer.data());
+    // Where the spectral envelope should end up: at the source formants
+    // (preservation), or moved with the harmonics; then by the formant shift.
+    // Only when that differs from where the shift carries it is it reshaped.
+    const float envelopeRatio = formantRatio * (formantPreservation ? 1.0f : pitchRatio);
+    const bool reshapeEnvelope = std::abs(envelopeRatio - pitchRatio) > 1.0e-4f;
+    const bool isIdentity = std::abs(pitchRatio - 1.0f) < 1.0e-4f && ! reshapeEnvelope;
     
-    for (int i = 0; i < numSamples; ++i)
+    // Analysis: magnitude and true frequency (in bins) from the phase advance
+    for (int k = 0; k < numBins; ++k)
     {
-        float sourceIndex = i / pitchRatio;
-        int sourceIndexInt = static_cast<int>(sourceIndex);
-        float fraction = sourceIndex - sourceIndexInt;
+        const float re = frame[k * 2];
+        const float im = frame[k * 2 + 1];
+        const float phase = std::atan2(im, re);
         
-        if (sourceIndexInt >= 0 && sourceIndexInt < numSamples - 1)
+        float deltaPhase = phase - voice.lastPhase[k] - static_cast<float>(k) * expectedPhaseAdvance;
+        voice.lastPhase[k] = phase;
+        
+        // Wrap to [-pi, pi]
+        deltaPhase -= twoPi * std::round(deltaPhase / twoPi);
+        
+        analysisMagnitude[k] = std::sqrt(re * re + im * im);
+        analysisFrequency[k] = static_cast<float>(k) + deltaPhase / expectedPhaseAdvance;
+        
+        // At unity the spectrum is passed through untouched; keep the
+        // synthesis phase locked to it so a later shift starts seamlessly
+        if (isIdentity)
+            voice.sumPhase[k] = phase;
+    }
+    
+    if (! isIdentity)
+    {
+        // Flatten to the fine structure; the lifter stays below the pitch
+        // period so the harmonics are smoothed out of the envelope
+        if (reshapeEnvelope)
         {
-            // Linear interpolation
-            samples[i] = tempBuffer[sourceIndexInt] * (1.0f - fraction) + 
-                        tempBuffer[sourceIndexInt + 1] * fraction;
+            const bool voiced = analysis.pitchDetected && analysis.currentPitch > 0.0f;
+            const int lifterLength = voiced ? juce::roundToInt(0.5 * sampleRate / analysis.currentPitch)
+                                            : juce::roundToInt(0.001 * sampleRate);
+            
+            formantShifter.analyse(analysisMagnitude.data(), lifterLength);
+            formantShifter.removeEnvelope(analysisMagnitude.data());
         }
-        else if (sourceIndexInt >= 0 && sourceIndexInt < numSamples)
+        
+        // Synthesis: move each bin to ratio * k, scaling its true frequency
+        std::fill(synthesisMagnitude.begin(), synthesisMagnitude.end(), 0.0f);
+        std::fill(synthesisFrequency.begin(), synthesisFrequency.end(), 0.0f);
+        
+        for (int k = 0; k < numBins; ++k)
         {
-            samples[i] = tempBuffer[sourceIndexInt];
+            const int target = static_cast<int>(static_cast<float>(k) * pitchRatio + 0.5f);
+            if (target >= numBins)
+                break;
+            
+            synthesisMagnitude[target] += analysisMagnitude[k];
+            synthesisFrequency[target] = analysisFrequency[k] * pitchRatio;
         }
-        else
+        
+        if (reshapeEnvelope)
+            formantShifter.applyEnvelope(synthesisMagnitude.data(), envelopeRatio);
+        
+        for (int k = 0; k < numBins; ++k)
         {
-            samples[i] = 0.0f;
+            float phase = voice.sumPhase[k] + synthesisFrequency[k] * expectedPhaseAdvance;
+            phase -= twoPi * std::floor(phase / twoPi); // Keep accumulated phase bounded
+            voice.sumPhase[k] = phase;
+            
+            frame[k * 2] = synthesisMagnitude[k] * std::cos(phase);
+            frame[k * 2 + 1] = synthesisMagnitude[k] * std::sin(phase);
         }
     }
-}
-
-void AIPitchTuner::processPitchShift(juce::AudioBuffer<float>& buffer, int channel, float pitchRatio)
-{
-    float* channelData = buffer.getWritePointer(channel);
-    const int numSamples = buffer.getNumSamples();
     
-    // Use improved FFT-based pitch shifting for better quality
-    if (std::abs(pitchRatio - 1.0f) > 0.01f)
+    pitchShiftFFT->performRealOnlyInverseTransform(frame);
+    
+    // Synthesis window and normalised overlap-add into the output ring
+    for (int i = 0; i < fftSize; ++i)
     {
-        processPitchShiftFFT(channelData, numSamples, pitchRatio);
+        int index = voice.fifoPosition + i;
+        if (index >= fftSize)
+            index -= fftSize;
+        
+        voice.outputAccumulator[index] += frame[i] * windowBuffer[i] * overlapAddGain;
     }
 }
 
-void AIPitchTuner::processPitchShiftFFT(float* samples, int numSamples, float pitchRatio)
+//==============================================================================
+void AIPitchTuner::processPitchShiftPSOLA(ChannelVoice& voice, const ChannelVoice& analysis, float* samples, int numSamples)
 {
-    // Enhanced FFT-based pitch shifting with phase vocoder
-    // This provides much better quality than simple time-stretching
-    
-    // Validate FFT size is power of 2
-    if ((fftSize & (fftSize - 1)) != 0) {
-        jassertfalse; // FFT size must be power of 2
+    // Time-domain PSOLA: pitch marks follow the detected period through the
+    // input history, and two-period Hann grains around them are overlap-added
+    // one output period apart. Every grain sample is read no earlier than it
+    // was written, so nothing is reported to the host; the output trails the
+    // input by less than one period.
+    if (numSamples <= 0 || samples == nullptr || voice.psolaHistory.empty())
         return;
-    }
     
-    // Validate input parameters
-    if (numSamples <= 0 || samples == nullptr || std::abs(pitchRatio - 1.0f) < 0.001f) {
-        return; // No processing needed
-    }
+    const bool voiced = analysis.pitchDetected && analysis.currentPitch > 0.0f;
+    const int period = voiced ? juce::jlimit(2, maxPitchPeriod, juce::roundToInt(sampleRate / analysis.currentPitch))
+                              : unvoicedPeriod;
     
-    const int overlap = fftSize / 4; // 75% overlap for smooth results
-    const int stepSize = fftSize - overlap;
+    float* history = voice.psolaHistory.data();
+    const juce::int64 mask = voice.psolaMask;
     
-    for (int pos = 0; pos < numSamples - fftSize; pos += stepSize)
+    for (int i = 0; i < numSamples; ++i)
     {
-        // Apply window and copy to FFT buffer with bounds checking
-        for (int i = 0; i < fftSize; ++i)
-        {
-            if (pos + i < numSamples && i < static_cast<int>(windowBuffer.size()))
-            {
-                fftBuffer[i * 2] = samples[pos + i] * windowBuffer[i]; // Real part
-                fftBuffer[i * 2 + 1] = 0.0f; // Imaginary part
-            }
-            else
-            {
-                fftBuffer[i * 2] = 0.0f;
-                fftBuffer[i * 2 + 1] = 0.0f;
-            }
-        }
+        voice.currentPitchRatio = voice.pitchRatioSmoother.getNextValue();
         
-        // Perform FFT (using JUCE's FFT)
-        juce::dsp::FFT fft(static_cast<int>(std::log2(fftSize)));
-        fft.performRealOnlyForwardTransform(fftBuffer.data());
+        history[voice.psolaTime & mask] = samples[i];
+        ++voice.psolaTime;
         
-        // Phase vocoder processing
-        static std::vector<float> lastPhase(fftSize / 2 + 1, 0.0f);
-        static std::vector<float> sumPhase(fftSize / 2 + 1, 0.0f);
+        placePitchMark(voice, period, voiced);
         
-        for (int k = 0; k <= fftSize / 2; ++k)
+        if (--voice.samplesUntilNextGrain <= 0)
+            startGrain(voice, period);
+        
+        float output = 0.0f;
+        for (auto& grain : voice.grains)
         {
-            float magnitude = std::sqrt(fftBuffer[k * 2] * fftBuffer[k * 2] + fftBuffer[k * 2 + 1] * fftBuffer[k * 2 + 1]);
-            float phase = std::atan2(fftBuffer[k * 2 + 1], fftBuffer[k * 2]);
-            
-            float deltaPhase = phase - lastPhase[k];
-            lastPhase[k] = phase;
-            
-            // Unwrap phase
-            while (deltaPhase > juce::MathConstants<float>::pi) deltaPhase -= 2.0f * juce::MathConstants<float>::pi;
-            while (deltaPhase < -juce::MathConstants<float>::pi) deltaPhase += 2.0f * juce::MathConstants<float>::pi;
+            if (grain.length == 0)
+                continue;
             
-            // Calculate instantaneous frequency
-            float instFreq = k * 2.0f * juce::MathConstants<float>::pi / fftSize + deltaPhase / stepSize;
+            const float windowPosition = static_cast<float>(grain.position) * grain.windowIncrement;
+            const int index = static_cast<int>(windowPosition);
+            const float fraction = windowPosition - static_cast<float>(index);
+            const float window = grainWindow[static_cast<size_t>(index)]
+                               + fraction * (grainWindow[static_cast<size_t>(index + 1)] - grainWindow[static_cast<size_t>(index)]);
             
-            // Adjust frequency for pitch shifting
-            float newFreq = instFreq * pitchRatio;
+            output += window * history[(grain.readStart + grain.position) & mask];
             
-            // Update phase
-            sumPhase[k] += newFreq * stepSize;
-            
-            // Convert back to complex
-            fftBuffer[k * 2] = magnitude * std::cos(sumPhase[k]);
-            fftBuffer[k * 2 + 1] = magnitude * std::sin(sumPhase[k]);
+            if (++grain.position >= grain.length)
+                grain.length = 0;
         }
         
-        // Perform inverse FFT
-        fft.performRealOnlyInverseTransform(fftBuffer.data());
-        
-        // Apply window and overlap-add
-        for (int i = 0; i < fftSize && pos + i < numSamples; ++i)
+        samples[i] = output;
+    }
+}
+
+void AIPitchTuner::placePitchMark(ChannelVoice& voice, int period, bool voiced)
+{
+    // The next mark sits one period after the last. Voiced marks snap to the
+    // strongest positive peak within a quarter period once it has arrived,
+    // so grains stay centred on the glottal pulses.
+    const int radius = voiced ? period / 4 : 0;
+    const juce::int64 newest = voice.psolaTime - 1;
+    
+    // After a reset or a long bypass the last mark may have left the history
+    if (voice.lastPitchMark < newest - voice.psolaMask / 2)
+        voice.lastPitchMark = newest - radius - period;
+    
+    const juce::int64 predicted = voice.lastPitchMark + period;
+    if (predicted + radius > newest)
+        return;
+    
+    const float* history = voice.psolaHistory.data();
+    const juce::int64 mask = voice.psolaMask;
+    
+    juce::int64 mark = predicted;
+    float peak = history[predicted & mask];
+    
+    for (juce::int64 t = predicted - radius; t <= predicted + radius; ++t)
+    {
+        if (history[t & mask] > peak)
         {
-            samples[pos + i] = fftBuffer[i] * windowBuffer[i] * 0.5f; // Scale down for overlap only
+            peak = history[t & mask];
+            mark = t;
         }
     }
+    
+    voice.lastPitchMark = mark;
+}
+
+void AIPitchTuner::startGrain(ChannelVoice& voice, int period)
+{
+    // Raising the pitch shortens the grains to two output periods (which
+    // overlap to unity); lowering keeps two input periods and leaves gaps,
+    // so each output period carries exactly one pulse
+    const float ratio = juce::jlimit(0.25f, 4.0f, voice.currentPitchRatio);
+    const int outputPeriod = juce::jmax(1, juce::roundToInt(static_cast<float>(period) / ratio));
+    const int halfLength = juce::jmax(1, juce::jmin(period, outputPeriod));
+    
+    voice.samplesUntilNextGrain = outputPeriod;
+    
+    // Centre on the latest point of the mark grid that is at most halfLength
+    // ahead of now: the grain centre plays halfLength samples from now, so
+    // every read is causal and the delay stays below one period
+    const juce::int64 now = voice.psolaTime - 1;
+    const juce::int64 steps = (now + halfLength - voice.lastPitchMark) / period;
+    const juce::int64 centre = voice.lastPitchMark + steps * period;
+    
+    // Take a free slot, or replace the grain closest to finishing
+    auto* slot = &voice.grains[0];
+    for (auto& grain : voice.grains)
+    {
+        if (grain.length == 0)
+        {
+            slot = &grain;
+            break;
+        }
+        
+        if (grain.length - grain.position < slot->length - slot->position)
+            slot = &grain;
+    }
+    
+    slot->readStart = centre - halfLength;
+    slot->length = halfLength * 2;
+    slot->position = 0;
+    slot->windowIncrement = static_cast<float>(grainWindowSize) / static_cast<float>(slot->length);
 }
 
 //==============================================================================
@@ -433,18 +1003,20 @@ float AIPitchTuner::midiToFrequency(float midiNote)
 float AIPitchTuner::quantizeToScale(float midiNote, int scaleMode)
 {
     // Scale patterns (semitones from root)
-    static const std::vector<std::vector<int>> scales = {
-        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}, // Chromatic
-        {0, 2, 4, 5, 7, 9, 11},                  // Major
-        {0, 2, 3, 5, 7, 8, 10},                  // Minor
-        {0, 2, 4, 6, 7, 9, 11},                  // Lydian
-        {0, 1, 3, 5, 7, 8, 10},                  // Dorian
-        {0, 2, 3, 5, 7, 9, 10},                  // Mixolydian
-        {0, 1, 3, 5, 6, 8, 10},                  // Phrygian
-        {0, 2, 3, 6, 7, 8, 11}                   // Locrian
+    // (constant tables: no first-call allocation on the audio thread)
+    struct ScalePattern { int numNotes; int notes[12]; };
+    static constexpr ScalePattern scales[] = {
+        { 12, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11} }, // Chromatic
+        { 7,  {0, 2, 4, 5, 7, 9, 11} },                 // Major
+        { 7,  {0, 2, 3, 5, 7, 8, 10} },                 // Minor
+        { 7,  {0, 2, 4, 6, 7, 9, 11} },                 // Lydian
+        { 7,  {0, 1, 3, 5, 7, 8, 10} },                 // Dorian
+        { 7,  {0, 2, 3, 5, 7, 9, 10} },                 // Mixolydian
+        { 7,  {0, 1, 3, 5, 6, 8, 10} },                 // Phrygian
+        { 7,  {0, 2, 3, 6, 7, 8, 11} }                  // Locrian
     };
     
-    if (scaleMode < 0 || scaleMode >= static_cast<int>(scales.size()))
+    if (scaleMode < 0 || scaleMode >= static_cast<int>(std::size(scales)))
         return midiNote;
     
     const auto& scale = scales[scaleMode];
@@ -456,8 +1028,9 @@ float AIPitchTuner::quantizeToScale(float midiNote, int scaleMode)
     float closestNote = noteInOctave;
     float minDistance = 12.0f;
     
-    for (int scaleNote : scale)
+    for (int n = 0; n < scale.numNotes; ++n)
     {
+        const int scaleNote = scale.notes[n];
         float distance = std::abs(noteInOctave - scaleNote);
         if (distance < minDistance)
         {
@@ -573,8 +1146,9 @@ float AIPitchTuner::calculatePitchConfidence(const float* samples, int numSample
         int yinPeriod = static_cast<int>(sampleRate / yinPitch);
         if (yinPeriod > 0 && yinPeriod < static_cast<int>(yinBuffer.size()))
         {
+            // yinBuffer holds the normalized difference, 0 = perfectly periodic
             float yinValue = yinBuffer[yinPeriod];
-            yinConfidence = juce::jlimit(0.0f, 1.0f, 1.0f - yinValue * 10.0f);
+            yinConfidence = juce::jlimit(0.0f, 1.0f, 1.0f - yinValue);
         }
     }
     
@@ -589,34 +1163,28 @@ float AIPitchTuner::calculatePitchConfidence(const float* samples, int numSample
     return juce::jlimit(0.0f, 1.0f, totalConfidence);
 }
 
-float AIPitchTuner::detectVocalFormants(const float* samples, int numSamples)
+float* AIPitchTuner::computeFeatureSpectrum(ScratchArena::ScopedFrame& scratch, const float* samples)
+{
+    // 1024 point magnitude spectrum (512 bins) of the first 1024 samples
+    auto* fft = fftPlans.get(spectralFeatureOrder);
+    const int size = 1 << spectralFeatureOrder;
+    float* fftData = scratch.allocate(static_cast<size_t>(size) * 2);
+    
+    if (fft == nullptr || fftData == nullptr)
+        return nullptr;
+    
+    // Every other point of the periodic fftSize Hann is a periodic 1024 point Hann
+    const int windowStride = fftSize / size;
+    for (int i = 0; i < size; ++i)
+        fftData[i] = samples[i] * windowBuffer[static_cast<size_t>(i * windowStride)];
+    
+    // Frequency-only transform leaves the magnitudes in fftData[0 .. size / 2]
+    fft->performFrequencyOnlyForwardTransform(fftData);
+    return fftData;
+}
+
+float AIPitchTuner::formantEnergyFromSpectrum(const float* spectrum) const
 {
-    if (numSamples < 1024) return 0.0f;
-    
-    // Simple formant detection using spectral peaks
-    std::vector<float> spectrum(512, 0.0f);
-    
-    // Apply window and FFT
-    std::vector<float> windowedSamples(1024, 0.0f);
-    for (int i = 0; i < juce::jmin(1024, numSamples); ++i)
-    {
-        windowedSamples[i] = samples[i] * windowBuffer[i];
-    }
-    
-    // Perform FFT
-    juce::dsp::FFT fft(10); // 1024 point FFT
-    std::vector<float> fftData(2048, 0.0f);
-    std::copy(windowedSamples.begin(), windowedSamples.end(), fftData.begin());
-    fft.performFrequencyOnlyForwardTransform(fftData.data());
-    
-    // Calculate magnitude spectrum
-    for (int i = 0; i < 512; ++i)
-    {
-        float real = fftData[i * 2];
-        float imag = fftData[i * 2 + 1];
-        spectrum[i] = std::sqrt(real * real + imag * imag);
-    }
-    
     // Find formant peaks (typically around 800-2000 Hz for vocals)
     float formantEnergy = 0.0f;
     int formantStart = static_cast<int>(800.0f * 512.0f / (sampleRate / 2.0f));
@@ -630,35 +1198,8 @@ float AIPitchTuner::detectVocalFormants(const float* samples, int numSamples)
     return juce::jlimit(0.0f, 1.0f, formantEnergy / 100.0f);
 }
 
-float AIPitchTuner::calculateSpectralCentroid(const float* samples, int numSamples)
+float AIPitchTuner::spectralCentroidFromSpectrum(const float* spectrum) const
 {
-    if (numSamples < 1024) return 0.0f;
-    
-    // Calculate spectral centroid (brightness indicator)
-    std::vector<float> spectrum(512, 0.0f);
-    
-    // Apply window and FFT
-    std::vector<float> windowedSamples(1024, 0.0f);
-    for (int i = 0; i < juce::jmin(1024, numSamples); ++i)
-    {
-        windowedSamples[i] = samples[i] * windowBuffer[i];
-    }
-    
-    // Perform FFT
-    juce::dsp::FFT fft(10);
-    std::vector<float> fftData(2048, 0.0f);
-    std::copy(windowedSamples.begin(), windowedSamples.end(), fftData.begin());
-    fft.performFrequencyOnlyForwardTransform(fftData.data());
-    
-    // Calculate magnitude spectrum
-    for (int i = 0; i < 512; ++i)
-    {
-        float real = fftData[i * 2];
-        float imag = fftData[i * 2 + 1];
-        spectrum[i] = std::sqrt(real * real + imag * imag);
-    }
-    
-    // Calculate spectral centroid
     float weightedSum = 0.0f;
     float magnitudeSum = 0.0f;
     
@@ -677,15 +1218,40 @@ float AIPitchTuner::calculateSpectralCentroid(const float* samples, int numSampl
     return 0.0f;
 }
 
+float AIPitchTuner::detectVocalFormants(const float* samples, int numSamples)
+{
+    if (numSamples < 1024) return 0.0f;
+    
+    // Simple formant detection using spectral peaks
+    ScratchArena::ScopedFrame scratch(scratchArena);
+    const float* spectrum = computeFeatureSpectrum(scratch, samples);
+    return spectrum != nullptr ? formantEnergyFromSpectrum(spectrum) : 0.0f;
+}
+
+float AIPitchTuner::calculateSpectralCentroid(const float* samples, int numSamples)
+{
+    if (numSamples < 1024) return 0.0f;
+    
+    // Calculate spectral centroid (brightness indicator)
+    ScratchArena::ScopedFrame scratch(scratchArena);
+    const float* spectrum = computeFeatureSpectrum(scratch, samples);
+    return spectrum != nullptr ? spectralCentroidFromSpectrum(spectrum) : 0.0f;
+}
+
 bool AIPitchTuner::isVocalSignal(const float* samples, int numSamples)
 {
     if (numSamples < 1024) return false;
     
+    // One spectrum feeds both spectral criteria
+    ScratchArena::ScopedFrame scratch(scratchArena);
+    const float* spectrum = computeFeatureSpectrum(scratch, samples);
+    if (spectrum == nullptr) return false;
+    
     // Multi-criteria vocal detection
     float rms = calculateRMS(samples, numSamples);
-    float formantEnergy = detectVocalFormants(samples, numSamples);
+    float formantEnergy = formantEnergyFromSpectrum(spectrum);
     float harmonicity = calculateHarmonicity(samples, numSamples);
-    float spectralCentroid = calculateSpectralCentroid(samples, numSamples);
+    float spectralCentroid = spectralCentroidFromSpectrum(spectrum);
     
     // Vocal characteristics
     bool hasEnergy = rms > 0.01f;
@@ -1,23 +1,43 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "RealtimeResources.h"
+#include "MidiVoicePool.h"
+#include "FormantShifter.h"
 #include <vector>
 #include <complex>
 #include <memory>
+#include <array>
 
 //==============================================================================
 /**
     AI-Powered Pitch Tuning System
     
     Features:
-    - Real-time pitch detection using autocorrelation
+    - Real-time pitch detection (YIN or FFT-based autocorrelation)
     - Smooth pitch correction with configurable strength
-    - Natural-sounding pitch shifting
-    - Low latency processing
+    - Streaming phase vocoder pitch shifting (works at any host block size)
+    - Zero-latency TD-PSOLA tracking engine, selectable per instance
+    - Cepstral formant preservation and formant shift (phase vocoder)
+    - Constant, host-reported latency
+    - Independent per-channel voices, or linked stereo (one mid analysis)
 */
 class AIPitchTuner
 {
 public:
+    //==============================================================================
+    enum class PitchDetectionAlgorithm
+    {
+        YIN = 0,
+        Autocorrelation
+    };
+    
+    enum class PitchShiftEngine
+    {
+        PhaseVocoder = 0,   // 2048 point STFT, fftSize samples of latency
+        PSOLA               // Pitch-synchronous grains, no reported latency
+    };
+    
     //==============================================================================
     AIPitchTuner();
     ~AIPitchTuner();
@@ -25,14 +45,27 @@ public:
     //==============================================================================
     void prepare(double sampleRate, int blockSize, int numChannels);
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    void processBypassed(juce::AudioBuffer<float>& buffer); // Latency-matched pass-through
     void reset();
     
+    // Fixed STFT latency (zero for PSOLA), valid after prepare()
+    int getLatencySamples() const { return isPrepared && shiftEngine == PitchShiftEngine::PhaseVocoder ? fftSize : 0; }
+    
     //==============================================================================
     // Parameter Controls
     void setPitchCorrection(float strength); // 0.0 to 1.0
     void setPitchSpeed(float speed);         // 0.0 to 1.0
     void setKeyCenter(float frequency);      // Hz
     void setScaleMode(int mode);             // 0=Chromatic, 1=Major, 2=Minor, etc.
+    void setDetectionAlgorithm(PitchDetectionAlgorithm algorithm);
+    void setYinThreshold(float threshold);   // 0.01 to 0.5 (CMND dip threshold)
+    void setLinkedStereo(bool shouldLink);   // Detect once on (L+R)/2, correct both channels
+    void setCorrectionEnabled(bool shouldCorrect); // Off: signal delayed only
+    void setAnalysisEnabled(bool shouldAnalyse);   // Keep detecting while correction is off (harmony)
+    void setMidiTargetMode(bool shouldUseMidi); // Latest held MIDI note is the target; none held = no correction
+    void setPitchShiftEngine(PitchShiftEngine engine); // Changes getLatencySamples()
+    void setFormantPreservation(bool shouldPreserve); // Corrected voice keeps its source formants (default on)
+    void setFormantShift(float semitones);   // -12 to +12, phase vocoder only (PSOLA keeps formants)
     
     //==============================================================================
     // Analysis Results
@@ -40,6 +73,12 @@ public:
     float getPitchConfidence() const { return pitchConfidence; }
     bool isPitchDetected() const { return pitchDetected; }
     
+    // Per-channel analysis shared with downstream synthesis (harmony voices),
+    // in Hz, 0 when unvoiced or not analysing. The detected pitch is the
+    // input's; the output pitch includes the correction being applied.
+    float getDetectedPitch(int channel) const;
+    float getOutputPitch(int channel) const;
+    
     //==============================================================================
     // Helper Functions
     float frequencyToMidi(float frequency);
@@ -54,6 +93,7 @@ public:
     // Mathematical Functions
     float calculateRMS(const float* samples, int numSamples);
     float calculateAutocorrelation(const float* samples, int numSamples, int lag);
+    float autocorrelationPitchDetection(const float* samples, int numSamples); // FFT, every lag at once
     float findPeakInRange(const float* data, int start, int end);
     
     // Advanced AI Features
@@ -65,19 +105,98 @@ public:
 
 private:
     //==============================================================================
+    // Per-channel state: analysis ring, detection results, smoothers and
+    // phase vocoder phase. Scratch buffers and FFT plans stay shared
+    // because channels are processed one after another.
+    struct ChannelVoice
+    {
+        // Sliding analysis ring
+        std::vector<float> pitchBuffer;
+        int currentHopPosition = 0;          // Ring write position
+        int samplesSinceLastAnalysis = 0;
+        int numBufferedSamples = 0;          // Valid samples in the ring (until it first fills)
+        double runningEnergy = 0.0;          // Sum of squares over the ring, updated per sample
+        
+        // Latest detection
+        float currentPitch = 0.0f;
+        float pitchConfidence = 0.0f;
+        bool pitchDetected = false;
+        float targetPitchRatio = 1.0f;
+        float currentPitchRatio = 1.0f;
+        
+        // Smoothing
+        juce::LinearSmoothedValue<float> pitchRatioSmoother;
+        juce::LinearSmoothedValue<float> pitchSmoother;
+        
+        // Streaming phase vocoder state
+        std::vector<float> inputFifo;        // Last fftSize input samples (ring)
+        std::vector<float> outputAccumulator; // Overlap-add ring, read fftSize samples later
+        int fifoPosition = 0;                // Shared write/read index into both rings
+        int samplesUntilNextFrame = 0;
+        int frameHopSize = 0;
+        std::vector<float> lastPhase;
+        std::vector<float> sumPhase;
+        
+        // PSOLA state: input history, pitch marks and the grains being overlap-added
+        struct Grain
+        {
+            juce::int64 readStart = 0;       // Input time of the first grain sample
+            int length = 0;                  // 0 = inactive
+            int position = 0;
+            float windowIncrement = 0.0f;    // Window table steps per sample
+        };
+        
+        std::vector<float> psolaHistory;     // Power of two ring, indexed by input time
+        int psolaMask = 0;
+        juce::int64 psolaTime = 0;           // Input samples written so far
+        juce::int64 lastPitchMark = 0;       // Input time of the latest placed mark
+        int samplesUntilNextGrain = 0;
+        std::array<Grain, 4> grains;
+        
+        void prepare(int analysisSize, int stftSize, int stftHop, int psolaHistorySize, int smoothingSteps);
+        void reset();
+        void resetShifters();
+    };
+    
+    //==============================================================================
+    // Block segments between MIDI events (sample-accurate retargeting)
+    void processSegment(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int numChannelsToProcess);
+    void retargetVoices();
+    
+    // Hop-based Analysis Pipeline
+    void analyseSamples(ChannelVoice& voice, const float* left, const float* right, int numSamples);
+    void pushAnalysisSample(ChannelVoice& voice, float sample);
+    void runHopAnalysis(ChannelVoice& voice);
+    void updatePitchEstimate(ChannelVoice& voice, float detectedPitch);
+    int getPitchSmoothingSteps() const;
+    
     // Pitch Detection
     float detectPitch(const float* samples, int numSamples);
-    float autocorrelationPitchDetection(const float* samples, int numSamples);
     float yinPitchDetection(const float* samples, int numSamples);
     
+    // Autocorrelation Engine (Wiener-Khinchin, zero-padded real FFT)
+    void prepareAutocorrelationEngine();
+    int computeAutocorrelation(const float* samples, int numSamples, int maxLag);
+    
+    // Spectral Features (magnitudes live in the caller's scratch frame)
+    float* computeFeatureSpectrum(ScratchArena::ScopedFrame& scratch, const float* samples);
+    float formantEnergyFromSpectrum(const float* spectrum) const;
+    float spectralCentroidFromSpectrum(const float* spectrum) const;
+    
     // Pitch Correction
     float calculateTargetPitch(float detectedPitch);
     void applyPitchCorrection(juce::AudioBuffer<float>& buffer, int channel, float targetPitch);
     
-    // Pitch Shifting (Improved FFT-based)
-    void pitchShift(float* samples, int numSamples, float pitchRatio);
-    void processPitchShift(juce::AudioBuffer<float>& buffer, int channel, float pitchRatio);
-    void processPitchShiftFFT(float* samples, int numSamples, float pitchRatio);
+    // Pitch Shifting (Streaming STFT phase vocoder)
+    void processPitchShift(ChannelVoice& voice, const ChannelVoice& analysis, float* samples, int numSamples,
+                           float pitchRatio, float formantRatio);
+    void processPitchShiftFFT(ChannelVoice& voice, const ChannelVoice& analysis, float* samples, int numSamples, float formantRatio);
+    void processPhaseVocoderFrame(ChannelVoice& voice, const ChannelVoice& analysis, float pitchRatio, float formantRatio);
+    
+    // Pitch Shifting (TD-PSOLA on the detected period)
+    void processPitchShiftPSOLA(ChannelVoice& voice, const ChannelVoice& analysis, float* samples, int numSamples);
+    void placePitchMark(ChannelVoice& voice, int period, bool voiced);
+    void startGrain(ChannelVoice& voice, int period);
     
     //==============================================================================
     // Processing State
@@ -86,15 +205,45 @@ private:
     int numChannels = 2;
     bool isPrepared = false;
     
+    // Per-channel Voices
+    std::vector<ChannelVoice> voices;
+    bool linkedStereo = false;
+    
     // Pitch Detection State
-    std::vector<float> pitchBuffer;
+    std::vector<float> analysisFrame;    // Linearized (oldest-first) view of a voice's ring
     std::vector<float> autocorrelationBuffer;
     std::vector<float> yinBuffer;
     int pitchBufferSize = 2048;
     int hopSize = 256;
-    int currentHopPosition = 0;
+    static constexpr float analysisSilenceThreshold = 0.001f; // -60 dBFS RMS
+    
+    // FFT plans and scratch space, created off the audio thread
+    FFTPlanCache fftPlans;
+    ScratchArena scratchArena;               // Spectral feature helpers
+    static constexpr int spectralFeatureOrder = 10; // 1024 point analysis
+    
+    // Autocorrelation FFT State (sized in prepare, reused on the audio thread)
+    juce::dsp::FFT* autocorrelationFFT = nullptr;
+    std::vector<float> autocorrelationFFTBuffer;
+    std::vector<float> yinFFTBuffer;         // Second spectrum for the YIN cross term
+    std::vector<double> yinEnergyPrefix;     // Prefix sums of x^2 for the YIN energy terms
+    int autocorrelationFFTSize = 0;
     
-    // Current Analysis Results
+    // Detector Selection
+    PitchDetectionAlgorithm detectionAlgorithm = PitchDetectionAlgorithm::YIN;
+    float yinThreshold = 0.15f;
+    float lastDetectionConfidence = 0.0f;
+    
+    bool correctionEnabled = true;
+    bool analysisEnabled = false;
+    
+    bool isAnalysing() const noexcept { return correctionEnabled || analysisEnabled; }
+    
+    // MIDI Target Mode
+    bool midiTargetMode = false;
+    MidiVoicePool heldNotes;
+    
+    // Reported Analysis Results (first voice, or the linked mid voice)
     float currentPitch = 0.0f;
     float pitchConfidence = 0.0f;
     bool pitchDetected = false;
@@ -105,20 +254,30 @@ private:
     float keyCenter = 440.0f; // A4
     int scaleMode = 0; // Chromatic
     
-    // Pitch Shifting State
-    std::vector<float> pitchShiftBuffer;
-    std::vector<float> overlapBuffer;
+    // Pitch Shifting State (shared scratch; per-channel FIFOs live in ChannelVoice)
+    juce::dsp::FFT* pitchShiftFFT = nullptr;
     std::vector<float> fftBuffer;
-    std::vector<float> windowBuffer;
+    std::vector<float> windowBuffer;         // Periodic Hann, used for analysis and synthesis
+    std::vector<float> analysisMagnitude;
+    std::vector<float> analysisFrequency;    // True frequency in bins
+    std::vector<float> synthesisMagnitude;
+    std::vector<float> synthesisFrequency;
     std::vector<float> tempBuffer; // Reusable temporary buffer
-    int pitchShiftBufferSize = 4096;
     int fftSize = 2048;
-    float currentPitchRatio = 1.0f;
-    float targetPitchRatio = 1.0f;
+    int stftHopSize = 512;                   // fftSize / 4 (75% overlap)
+    float overlapAddGain = 1.0f;             // Normalises the summed squared windows to unity
+    
+    // Formant State (envelope scratch shared like the vocoder's)
+    FormantShifter formantShifter;
+    bool formantPreservation = true;
+    float formantShiftRatio = 1.0f;
     
-    // Smoothing
-    juce::LinearSmoothedValue<float> pitchRatioSmoother;
-    juce::LinearSmoothedValue<float> pitchSmoother;
+    // PSOLA State (per-channel history and grains live in ChannelVoice)
+    PitchShiftEngine shiftEngine = PitchShiftEngine::PhaseVocoder;
+    static constexpr int grainWindowSize = 1024;
+    std::array<float, grainWindowSize + 1> grainWindow {}; // Hann, both ends included
+    int maxPitchPeriod = 552;                // Samples at the lowest tracked pitch
+    int unvoicedPeriod = 220;                // Grain spacing when nothing is detected
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AIPitchTuner)
 };
@@ -0,0 +1,132 @@
+#include "AudioThreadGuard.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//==============================================================================
+namespace
+{
+    thread_local int realtimeDepth = 0;
+    thread_local int allowDepth = 0;
+    std::atomic<std::uint64_t> violationCount { 0 };
+    std::atomic<bool> assertOnViolation { true };
+}
+
+//==============================================================================
+AudioThreadGuard::ScopedRealtimeSection::ScopedRealtimeSection() noexcept
+{
+    ++realtimeDepth;
+}
+
+AudioThreadGuard::ScopedRealtimeSection::~ScopedRealtimeSection()
+{
+    --realtimeDepth;
+}
+
+AudioThreadGuard::ScopedAllowAllocation::ScopedAllowAllocation() noexcept
+{
+    ++allowDepth;
+}
+
+AudioThreadGuard::ScopedAllowAllocation::~ScopedAllowAllocation()
+{
+    --allowDepth;
+}
+
+bool AudioThreadGuard::isInRealtimeSection() noexcept
+{
+    return realtimeDepth > 0 && allowDepth == 0;
+}
+
+std::uint64_t AudioThreadGuard::getViolationCount() noexcept
+{
+    return violationCount.load(std::memory_order_relaxed);
+}
+
+void AudioThreadGuard::setAssertOnViolation(bool shouldAssert) noexcept
+{
+    assertOnViolation.store(shouldAssert, std::memory_order_relaxed);
+}
+
+void AudioThreadGuard::notifyHeapOperation() noexcept
+{
+    if (! isInRealtimeSection())
+        return;
+    
+    violationCount.fetch_add(1, std::memory_order_relaxed);
+    
+   #if VOCALAI_DETECT_AUDIO_THREAD_ALLOCATIONS
+    if (! assertOnViolation.load(std::memory_order_relaxed))
+        return;
+    
+    // Reporting the assertion allocates too; don't recurse into it
+    ScopedAllowAllocation allowReporting;
+    jassertfalse; // Heap touched under VocalAIProPlugin::processBlock
+   #endif
+}
+
+//==============================================================================
+// Global heap replacements (debug builds only). Aligned overloads are left
+// to the runtime.
+#if VOCALAI_DETECT_AUDIO_THREAD_ALLOCATIONS
+
+void* operator new(std::size_t size)
+{
+    AudioThreadGuard::notifyHeapOperation();
+    
+    if (void* memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+    
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    AudioThreadGuard::notifyHeapOperation();
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory != nullptr)
+        AudioThreadGuard::notifyHeapOperation();
+    
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    operator delete(memory);
+}
+
+#endif
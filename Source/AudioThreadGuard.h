@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+
+// Debug builds replace global operator new/delete and assert when they are
+// reached from inside a ScopedRealtimeSection. Define to 0 to opt out.
+#ifndef VOCALAI_DETECT_AUDIO_THREAD_ALLOCATIONS
+ #if JUCE_DEBUG
+  #define VOCALAI_DETECT_AUDIO_THREAD_ALLOCATIONS 1
+ #else
+  #define VOCALAI_DETECT_AUDIO_THREAD_ALLOCATIONS 0
+ #endif
+#endif
+
+//==============================================================================
+/**
+    Audio Thread Allocation Guard
+    
+    Mark real-time code with ScopedRealtimeSection. While one is active on a
+    thread, any heap allocation or deallocation on that thread is counted
+    and, with detection enabled, fails a jassert.
+*/
+namespace AudioThreadGuard
+{
+    //==============================================================================
+    class ScopedRealtimeSection
+    {
+    public:
+        ScopedRealtimeSection() noexcept;
+        ~ScopedRealtimeSection();
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+    };
+    
+    // Temporarily permits heap use inside a realtime section (e.g. logging)
+    class ScopedAllowAllocation
+    {
+    public:
+        ScopedAllowAllocation() noexcept;
+        ~ScopedAllowAllocation();
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedAllowAllocation)
+    };
+    
+    //==============================================================================
+    bool isInRealtimeSection() noexcept;
+    
+    // Total heap operations seen inside realtime sections (all threads)
+    std::uint64_t getViolationCount() noexcept;
+    
+    // Tools that report the count themselves (the benchmark) can turn the
+    // jassert off and keep counting
+    void setAssertOnViolation(bool shouldAssert) noexcept;
+    
+    // Called by the operator new/delete replacements
+    void notifyHeapOperation() noexcept;
+}
@@ -0,0 +1,145 @@
+#include "DynamicEQ.h"
+
+namespace
+{
+    constexpr float envelopeAttackMs = 5.0f;
+    constexpr float envelopeReleaseMs = 80.0f;
+    constexpr float envelopeFloor = 1.0e-6f;   // Keeps threshold / envelope finite
+    constexpr float gainSmoothingMs = 20.0f;
+    constexpr float settledTolerance = 1.0e-4f; // About 0.001 dB
+
+    bool bandsDiffer(const DynamicEQ::BandParameters& a, const DynamicEQ::BandParameters& b) noexcept
+    {
+        return a.frequency != b.frequency || a.gainDb != b.gainDb || a.thresholdDb != b.thresholdDb
+            || a.rangeDb != b.rangeDb || a.q != b.q;
+    }
+}
+
+//==============================================================================
+void DynamicEQ::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    const float sr = static_cast<float>(sampleRate);
+    attackCoeff = 1.0f - std::exp(-1.0f / (envelopeAttackMs * 0.001f * sr));
+    releaseCoeff = 1.0f - std::exp(-1.0f / (envelopeReleaseMs * 0.001f * sr));
+    smoothingCoeff = 1.0f - std::exp(-1.0f / (gainSmoothingMs * 0.001f * sr));
+
+    for (int band = 0; band < numBands; ++band)
+        updateBand(band);
+}
+
+void DynamicEQ::setBand(int band, const BandParameters& newParameters)
+{
+    if (! juce::isPositiveAndBelow(band, numBands))
+        return;
+
+    BandParameters clamped;
+    clamped.frequency = juce::jlimit(20.0f, 20000.0f, newParameters.frequency);
+    clamped.gainDb = juce::jlimit(-12.0f, 12.0f, newParameters.gainDb);
+    clamped.thresholdDb = juce::jlimit(-60.0f, 0.0f, newParameters.thresholdDb);
+    clamped.rangeDb = juce::jlimit(-24.0f, 0.0f, newParameters.rangeDb);
+    clamped.q = juce::jlimit(0.1f, 10.0f, newParameters.q);
+
+    // Called every block; tan() and pow() only run on an actual change
+    if (! bandsDiffer(clamped, bands[static_cast<size_t>(band)]))
+        return;
+
+    bands[static_cast<size_t>(band)] = clamped;
+    updateBand(band);
+}
+
+void DynamicEQ::updateBand(int band)
+{
+    const auto& parameters = bands[static_cast<size_t>(band)];
+
+    // TPT state-variable filter (trapezoidal integrators), cutoff kept below Nyquist
+    const double cutoff = juce::jmin(static_cast<double>(parameters.frequency), 0.49 * sampleRate);
+    const float g = static_cast<float>(std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate));
+    const float damping = 1.0f / parameters.q;
+
+    a1.v[band] = 1.0f / (1.0f + g * (g + damping));
+    a2.v[band] = g * a1.v[band];
+    a3.v[band] = g * a2.v[band];
+    k.v[band] = damping;
+
+    staticGain.v[band] = juce::Decibels::decibelsToGain(parameters.gainDb);
+    threshold.v[band] = juce::Decibels::decibelsToGain(parameters.thresholdDb);
+    minimumGain.v[band] = juce::Decibels::decibelsToGain(parameters.rangeDb);
+}
+
+bool DynamicEQ::isNeutral() const noexcept
+{
+    for (const auto& band : bands)
+        if (band.gainDb != 0.0f || band.rangeDb != 0.0f)
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+void DynamicEQ::process(State& state, float* samples, int numSamples) const noexcept
+{
+    static_assert(numBands == 4, "The output sum below is written out for four lanes");
+
+    // Local copies: nothing can alias the output, so the lane loop stays vectorisable
+    const Lanes c1 = a1, c2 = a2, c3 = a3, damping = k;
+    const Lanes targetStaticGain = staticGain, targetMinimumGain = minimumGain, thresholdGain = threshold;
+    const float attack = attackCoeff, release = releaseCoeff, smoothing = smoothingCoeff;
+
+    Lanes ic1 = state.ic1;
+    Lanes ic2 = state.ic2;
+    Lanes envelope = state.envelope;
+    Lanes currentStaticGain = state.staticGain;
+    Lanes currentMinimumGain = state.minimumGain;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float input = samples[i];
+        Lanes contribution;
+
+        for (int b = 0; b < numBands; ++b)
+        {
+            // SVF tick; k * v1 is the band-pass with unity gain at the centre
+            const float v3 = input - ic2.v[b];
+            const float v1 = c1.v[b] * ic1.v[b] + c2.v[b] * v3;
+            const float v2 = ic2.v[b] + c2.v[b] * ic1.v[b] + c3.v[b] * v3;
+            ic1.v[b] = 2.0f * v1 - ic1.v[b];
+            ic2.v[b] = 2.0f * v2 - ic2.v[b];
+            const float bandPass = damping.v[b] * v1;
+
+            // Peak follower on the band (select, not a branch)
+            const float level = std::abs(bandPass);
+            const float coeff = level > envelope.v[b] ? attack : release;
+            envelope.v[b] += coeff * (level - envelope.v[b]);
+
+            // Gain and range glide to their targets, so parameter moves don't step
+            currentStaticGain.v[b] += smoothing * (targetStaticGain.v[b] - currentStaticGain.v[b]);
+            currentMinimumGain.v[b] += smoothing * (targetMinimumGain.v[b] - currentMinimumGain.v[b]);
+
+            // Above the threshold the band is pulled back to it, never below the range
+            const float pulledBack = thresholdGain.v[b] / std::max(envelope.v[b], envelopeFloor);
+            const float dynamicGain = std::max(currentMinimumGain.v[b], std::min(1.0f, pulledBack));
+
+            contribution.v[b] = (currentStaticGain.v[b] * dynamicGain - 1.0f) * bandPass;
+        }
+
+        samples[i] = input + ((contribution.v[0] + contribution.v[1]) + (contribution.v[2] + contribution.v[3]));
+    }
+
+    state.ic1 = ic1;
+    state.ic2 = ic2;
+    state.envelope = envelope;
+    state.staticGain = currentStaticGain;
+    state.minimumGain = currentMinimumGain;
+}
+
+bool DynamicEQ::hasSettled(const State& state) const noexcept
+{
+    for (int b = 0; b < numBands; ++b)
+        if (std::abs(state.staticGain.v[b] - staticGain.v[b]) > settledTolerance
+            || std::abs(state.minimumGain.v[b] - minimumGain.v[b]) > settledTolerance)
+            return false;
+
+    return true;
+}
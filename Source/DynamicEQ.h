@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Dynamic EQ
+
+    Four bell bands, each a TPT state-variable filter running on the same
+    input in parallel. Band b adds (gain_b - 1) times its unity-peak
+    band-pass to the signal, so a lone band is an exact bell. The gain is
+    the static boost/cut times a dynamic part: when the band's envelope
+    rises above its threshold the band is pulled down toward the
+    threshold, by at most its range.
+
+    The bands are the lanes of one aligned struct and each sample is one
+    plain loop over the four lanes (the FDNReverb layout, standing in for
+    SIMDRegister). GCC -O2 vectorises that loop (-fopt-info-vec); at -O3
+    it unrolls it instead and much of it stays scalar. Filter state lives
+    with the caller, one State per channel.
+*/
+class DynamicEQ
+{
+public:
+    //==============================================================================
+    static constexpr int numBands = 4;
+
+    struct alignas(16) Lanes
+    {
+        float v[numBands] {};
+    };
+
+    struct BandParameters
+    {
+        float frequency = 1000.0f;      // Hz
+        float gainDb = 0.0f;            // -12..12, static boost or cut
+        float thresholdDb = -20.0f;     // -60..0, band level where the dynamic cut starts
+        float rangeDb = 0.0f;           // -24..0, deepest dynamic cut
+        float q = 1.0f;
+    };
+
+    // Per-channel filter, envelope and smoothed gain state
+    struct State
+    {
+        Lanes ic1, ic2;                 // SVF integrator states
+        Lanes envelope;                 // Linear band level
+        Lanes staticGain { { 1.0f, 1.0f, 1.0f, 1.0f } };
+        Lanes minimumGain { { 1.0f, 1.0f, 1.0f, 1.0f } };
+    };
+
+    void prepare(double newSampleRate);
+
+    // Coefficients are recomputed only when the band actually changed
+    void setBand(int band, const BandParameters& newParameters);
+    const BandParameters& getBand(int band) const { return bands[static_cast<size_t>(juce::jlimit(0, numBands - 1, band))]; }
+
+    // True when no band is set to change the signal. Callers should keep
+    // calling process() until hasSettled() so the last move can glide out
+    bool isNeutral() const noexcept;
+    bool hasSettled(const State& state) const noexcept;
+
+    //==============================================================================
+    void process(State& state, float* samples, int numSamples) const noexcept;
+
+private:
+    //==============================================================================
+    void updateBand(int band);
+
+    double sampleRate = 44100.0;
+    std::array<BandParameters, numBands> bands;
+
+    // SVF coefficients per lane
+    Lanes a1, a2, a3, k;
+
+    // Gain computer per lane, all linear
+    Lanes staticGain;
+    Lanes threshold;
+    Lanes minimumGain;                  // Range floor of the dynamic part
+
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+    float smoothingCoeff = 1.0f;
+};
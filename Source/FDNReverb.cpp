@@ -0,0 +1,199 @@
+#include "FDNReverb.h"
+
+namespace
+{
+    // Line lengths at size 0.5 (scale 1), mutually prime-ish so echoes don't stack up
+    constexpr float lineDelaysMs[FDNReverb::numLines] = { 29.7f, 37.1f, 41.1f, 43.7f, 53.3f, 59.9f, 67.1f, 73.7f };
+    constexpr float lfoRatesHz[FDNReverb::numLines] = { 0.53f, 0.61f, 0.71f, 0.79f, 0.87f, 0.97f, 1.03f, 1.13f };
+
+    // Two orthogonal sign patterns for the output taps, one for the input
+    constexpr float leftTaps[FDNReverb::numLines] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+    constexpr float rightTaps[FDNReverb::numLines] = { 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f };
+    constexpr float inputTaps[FDNReverb::numLines] = { 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
+
+    constexpr float minScale = 0.5f;           // Line length scale at size 0
+    constexpr float maxScale = 1.5f;           // ... and at size 1
+    constexpr float modulationDepthMs = 0.25f;
+    constexpr float outputGain = 2.0f;         // Wet level close to Freeverb at the same settings
+}
+
+//==============================================================================
+void FDNReverb::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    // Room for the longest line at the largest size plus the modulation
+    // swing; the tap reads depth * (1 + sin), so up to twice the depth
+    const float longestMs = lineDelaysMs[numLines - 1] * maxScale + 2.0f * modulationDepthMs;
+    const int longestLine = static_cast<int>(std::ceil(longestMs * 0.001 * sampleRate)) + 2;
+    const int ringFrames = juce::nextPowerOfTwo(longestLine);
+
+    lines.assign(static_cast<size_t>(ringFrames * numLines), 0.0f);
+    lineMask = ringFrames - 1;
+
+    const int preDelayFrames = juce::nextPowerOfTwo(static_cast<int>(std::ceil(maxPreDelayMs * 0.001 * sampleRate)) + 1);
+    preDelayBuffer.assign(static_cast<size_t>(preDelayFrames), 0.0f);
+    preDelayMask = preDelayFrames - 1;
+
+    for (int k = 0; k < numLines; ++k)
+    {
+        baseDelays.v[k] = lineDelaysMs[k] * 0.001f * static_cast<float>(sampleRate);
+
+        const double omega = juce::MathConstants<double>::twoPi * lfoRatesHz[k] / sampleRate;
+        lfoRotSin.v[k] = static_cast<float>(std::sin(omega));
+        lfoRotCos.v[k] = static_cast<float>(std::cos(omega));
+    }
+
+    modulationDepth = modulationDepthMs * 0.001f * static_cast<float>(sampleRate);
+
+    // Size changes stretch the lines over 100 ms; the fractional taps glide with them
+    scaleSmoother.reset(sampleRate, 0.1);
+
+    reset();
+    updateCoefficients();
+    scaleSmoother.setCurrentAndTargetValue(scaleSmoother.getTargetValue());
+}
+
+void FDNReverb::reset()
+{
+    std::fill(lines.begin(), lines.end(), 0.0f);
+    std::fill(preDelayBuffer.begin(), preDelayBuffer.end(), 0.0f);
+    writeIndex = 0;
+    preDelayWrite = 0;
+
+    dampingStates = Lanes();
+
+    // Spread the LFO starting phases so the lines never move together
+    for (int k = 0; k < numLines; ++k)
+    {
+        const float phase = juce::MathConstants<float>::twoPi * static_cast<float>(k) / static_cast<float>(numLines);
+        lfoSin.v[k] = std::sin(phase);
+        lfoCos.v[k] = std::cos(phase);
+    }
+}
+
+void FDNReverb::setParameters(const Parameters& newParameters)
+{
+    parameters.size = juce::jlimit(0.0f, 1.0f, newParameters.size);
+    parameters.damping = juce::jlimit(0.0f, 1.0f, newParameters.damping);
+    parameters.width = juce::jlimit(0.0f, 1.0f, newParameters.width);
+    parameters.preDelayMs = juce::jlimit(0.0f, maxPreDelayMs, newParameters.preDelayMs);
+
+    updateCoefficients();
+}
+
+float FDNReverb::getDecayTimeSeconds(float size) noexcept
+{
+    size = juce::jlimit(0.0f, 1.0f, size);
+    return 0.3f + 3.7f * size * size;
+}
+
+void FDNReverb::updateCoefficients()
+{
+    const float sr = static_cast<float>(sampleRate);
+    const float scale = minScale + (maxScale - minScale) * parameters.size;
+    scaleSmoother.setTargetValue(scale);
+
+    // Decay: each line loses 60 dB per RT60 whatever its length
+    const float rt60 = getDecayTimeSeconds(parameters.size);
+    for (int k = 0; k < numLines; ++k)
+        decayGains.v[k] = std::pow(10.0f, -3.0f * baseDelays.v[k] * scale / (rt60 * sr));
+
+    // Damping: in-loop low-pass from 18 kHz down to 1 kHz
+    const float cutoff = juce::jmin(18000.0f * std::pow(1000.0f / 18000.0f, parameters.damping), 0.45f * sr);
+    dampingCoeff = 1.0f - std::exp(-juce::MathConstants<float>::twoPi * cutoff / sr);
+
+    outputWidth = parameters.width;
+    preDelaySamples = juce::jlimit(0, preDelayMask, juce::roundToInt(parameters.preDelayMs * 0.001f * sr));
+}
+
+//==============================================================================
+void FDNReverb::process(float* left, float* right, int numSamples, float wetLevel, float dryLevel) noexcept
+{
+    if (lines.empty() || left == nullptr)
+        return;
+
+    float* data = lines.data();
+    const float householder = 2.0f / static_cast<float>(numLines);
+    const float inputGain = 1.0f / std::sqrt(static_cast<float>(numLines));
+    const float tapGain = outputGain;
+
+    Lanes delayed, filtered;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float dryL = left[i];
+        const float dryR = right != nullptr ? right[i] : dryL;
+
+        // Pre-delay on the mono sum
+        preDelayBuffer[static_cast<size_t>(preDelayWrite & preDelayMask)] = 0.5f * (dryL + dryR);
+        const float input = preDelayBuffer[static_cast<size_t>((preDelayWrite - preDelaySamples) & preDelayMask)] * inputGain;
+        ++preDelayWrite;
+
+        const float scale = scaleSmoother.getNextValue();
+
+        // Modulated fractional read of every line (taps at least one frame back)
+        for (int k = 0; k < numLines; ++k)
+        {
+            const float delay = baseDelays.v[k] * scale + modulationDepth * (1.0f + lfoSin.v[k]);
+            const int whole = static_cast<int>(delay);
+            const float fraction = delay - static_cast<float>(whole);
+
+            const float a = data[((writeIndex - whole) & lineMask) * numLines + k];
+            const float b = data[((writeIndex - whole - 1) & lineMask) * numLines + k];
+            delayed.v[k] = a + fraction * (b - a);
+        }
+
+        // Damping and decay, then the Householder reflection I - 2/N * ones
+        float sum = 0.0f;
+        for (int k = 0; k < numLines; ++k)
+        {
+            dampingStates.v[k] += dampingCoeff * (delayed.v[k] - dampingStates.v[k]);
+            filtered.v[k] = dampingStates.v[k] * decayGains.v[k];
+            sum += filtered.v[k];
+        }
+
+        sum *= householder;
+
+        float* frame = data + (writeIndex & lineMask) * numLines;
+        for (int k = 0; k < numLines; ++k)
+            frame[k] = filtered.v[k] - sum + input * inputTaps[k];
+
+        ++writeIndex;
+
+        // Output taps, then mid/side width
+        float wetL = 0.0f, wetR = 0.0f;
+        for (int k = 0; k < numLines; ++k)
+        {
+            wetL += delayed.v[k] * leftTaps[k];
+            wetR += delayed.v[k] * rightTaps[k];
+        }
+
+        const float mid = 0.5f * (wetL + wetR);
+        const float side = 0.5f * (wetL - wetR) * outputWidth;
+
+        left[i] = dryL * dryLevel + (mid + side) * tapGain * wetLevel;
+        if (right != nullptr)
+            right[i] = dryR * dryLevel + (mid - side) * tapGain * wetLevel;
+
+        // Advance the LFOs by one rotation step
+        for (int k = 0; k < numLines; ++k)
+        {
+            const float s = lfoSin.v[k];
+            const float c = lfoCos.v[k];
+            lfoSin.v[k] = s * lfoRotCos.v[k] + c * lfoRotSin.v[k];
+            lfoCos.v[k] = c * lfoRotCos.v[k] - s * lfoRotSin.v[k];
+        }
+    }
+
+    // Keep the oscillators on the unit circle against rounding drift
+    for (int k = 0; k < numLines; ++k)
+    {
+        const float correction = 1.5f - 0.5f * (lfoSin.v[k] * lfoSin.v[k] + lfoCos.v[k] * lfoCos.v[k]);
+        lfoSin.v[k] *= correction;
+        lfoCos.v[k] *= correction;
+    }
+
+    writeIndex &= lineMask;
+    preDelayWrite &= preDelayMask;
+}
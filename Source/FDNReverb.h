@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+    Feedback Delay Network Reverb
+
+    Eight delay lines stored interleaved, one frame of eight lanes per
+    sample, so the damping, decay gains, Householder mix and LFOs run as
+    plain loops over eight contiguous floats that the compiler turns into
+    SIMD. Each line is read through a slowly modulated fractional tap to
+    keep the tail from ringing. A pre-delay sits in front of the network.
+
+    size maps to line lengths and decay time, damping to the in-loop
+    low-pass, width to the stereo spread of the output taps.
+*/
+class FDNReverb
+{
+public:
+    //==============================================================================
+    static constexpr int numLines = 8;
+    static constexpr float maxPreDelayMs = 250.0f;
+
+    struct Parameters
+    {
+        float size = 0.5f;          // 0..1
+        float damping = 0.5f;       // 0..1
+        float width = 1.0f;         // 0..1
+        float preDelayMs = 20.0f;   // 0..maxPreDelayMs
+    };
+
+    // Allocates every buffer for the largest size. Not real-time safe.
+    void prepare(double newSampleRate);
+    void reset();
+
+    void setParameters(const Parameters& newParameters);
+
+    // RT60 of the network at a given size (0.3 s to 4 s), excluding pre-delay
+    static float getDecayTimeSeconds(float size) noexcept;
+
+    //==============================================================================
+    // Mono input is the channel sum; right may be nullptr for a mono bus
+    void process(float* left, float* right, int numSamples, float wetLevel, float dryLevel) noexcept;
+
+private:
+    //==============================================================================
+    struct alignas(32) Lanes
+    {
+        float v[numLines] {};
+    };
+
+    void updateCoefficients();
+
+    double sampleRate = 44100.0;
+    Parameters parameters;
+
+    // Delay network: frame f holds lane k at lines[f * numLines + k]
+    std::vector<float> lines;
+    int lineMask = 0;
+    int writeIndex = 0;
+
+    std::vector<float> preDelayBuffer;
+    int preDelayMask = 0;
+    int preDelayWrite = 0;
+    int preDelaySamples = 0;
+
+    Lanes baseDelays;           // Samples at scale 1
+    Lanes decayGains;           // Per-line gain for the target RT60
+    Lanes dampingStates;
+    Lanes lfoSin, lfoCos;       // Quadrature oscillators, one per line
+    Lanes lfoRotSin, lfoRotCos;
+    float dampingCoeff = 0.5f;
+    float modulationDepth = 0.0f;
+    float outputWidth = 1.0f;
+
+    juce::LinearSmoothedValue<float> scaleSmoother;  // Line length scale, glides on size changes
+};
@@ -0,0 +1,91 @@
+#include "FormantShifter.h"
+
+namespace
+{
+    constexpr float magnitudeFloor = 1.0e-9f;   // Keeps log() finite on empty bins
+}
+
+//==============================================================================
+void FormantShifter::prepare(juce::dsp::FFT& fftToUse)
+{
+    fft = &fftToUse;
+    fftSize = fftToUse.getSize();
+    numBins = fftSize / 2 + 1;
+
+    cepstrum.assign(static_cast<size_t>(fftSize * 2), 0.0f);
+    envelope.assign(static_cast<size_t>(numBins), 1.0f);
+    inverseEnvelope.assign(static_cast<size_t>(numBins), 1.0f);
+    warpedEnvelope.assign(static_cast<size_t>(numBins), 1.0f);
+}
+
+void FormantShifter::reset()
+{
+    std::fill(cepstrum.begin(), cepstrum.end(), 0.0f);
+    std::fill(envelope.begin(), envelope.end(), 1.0f);
+    std::fill(inverseEnvelope.begin(), inverseEnvelope.end(), 1.0f);
+    std::fill(warpedEnvelope.begin(), warpedEnvelope.end(), 1.0f);
+}
+
+//==============================================================================
+void FormantShifter::analyse(const float* magnitudes, int lifterLength) noexcept
+{
+    if (fft == nullptr || magnitudes == nullptr)
+        return;
+
+    float* data = cepstrum.data();
+
+    // Log magnitude as a real, even spectrum
+    for (int k = 0; k < numBins; ++k)
+    {
+        data[k * 2] = std::log(juce::jmax(magnitudes[k], magnitudeFloor));
+        data[k * 2 + 1] = 0.0f;
+    }
+    juce::FloatVectorOperations::clear(data + numBins * 2, (fftSize - numBins) * 2);
+
+    fft->performRealOnlyInverseTransform(data);
+
+    // Lifter: keep quefrencies 0..L on both ends of the (even) cepstrum
+    const int keep = juce::jlimit(1, fftSize / 2 - 1, lifterLength);
+    juce::FloatVectorOperations::clear(data + keep + 1, fftSize - keep * 2 - 1);
+    juce::FloatVectorOperations::clear(data + fftSize, fftSize);
+
+    fft->performRealOnlyForwardTransform(data, true);
+
+    // Smoothed log spectrum back to linear; the inverse is cached for removeEnvelope()
+    for (int k = 0; k < numBins; ++k)
+    {
+        envelope[static_cast<size_t>(k)] = std::exp(data[k * 2]);
+        inverseEnvelope[static_cast<size_t>(k)] = 1.0f / envelope[static_cast<size_t>(k)];
+    }
+}
+
+void FormantShifter::removeEnvelope(float* magnitudes) const noexcept
+{
+    juce::FloatVectorOperations::multiply(magnitudes, inverseEnvelope.data(), numBins);
+}
+
+void FormantShifter::applyEnvelope(float* magnitudes, float warpRatio) noexcept
+{
+    if (std::abs(warpRatio - 1.0f) < 1.0e-4f)
+    {
+        juce::FloatVectorOperations::multiply(magnitudes, envelope.data(), numBins);
+        return;
+    }
+
+    // Read the envelope at k / warpRatio; past the top bin it holds its last value
+    const float step = 1.0f / warpRatio;
+    const int lastBin = numBins - 1;
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const float source = static_cast<float>(k) * step;
+        const int index = juce::jmin(static_cast<int>(source), lastBin);
+        const int next = juce::jmin(index + 1, lastBin);
+        const float fraction = juce::jmin(source - static_cast<float>(index), 1.0f);
+
+        warpedEnvelope[static_cast<size_t>(k)] = envelope[static_cast<size_t>(index)]
+            + fraction * (envelope[static_cast<size_t>(next)] - envelope[static_cast<size_t>(index)]);
+    }
+
+    juce::FloatVectorOperations::multiply(magnitudes, warpedEnvelope.data(), numBins);
+}
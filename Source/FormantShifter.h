@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Formant Shifter
+
+    Spectral envelope engine for the tuner's phase vocoder. Each frame's
+    envelope is estimated by cepstral smoothing: log magnitude, real
+    cepstrum, a lifter that keeps only quefrencies below the pitch period,
+    and back to the spectrum. Dividing it out leaves the harmonic fine
+    structure, which the vocoder moves to the corrected pitch before the
+    envelope is reapplied, warped by the formant ratio. Pitch and formants
+    therefore move independently.
+
+    Magnitudes, envelope and its inverse are separate arrays sized in
+    prepare(); the per-bin passes are flat loops and FloatVectorOperations.
+*/
+class FormantShifter
+{
+public:
+    //==============================================================================
+    // Uses the owner's plan, so frames match its STFT. Not real-time safe.
+    void prepare(juce::dsp::FFT& fftToUse);
+    void reset();
+
+    //==============================================================================
+    // Envelope of a frame's magnitudes (fftSize / 2 + 1 bins). lifterLength is
+    // the highest quefrency kept, in samples; keep it below the pitch period.
+    void analyse(const float* magnitudes, int lifterLength) noexcept;
+
+    // magnitudes /= envelope: leaves the fine structure
+    void removeEnvelope(float* magnitudes) const noexcept;
+
+    // magnitudes *= envelope(k / warpRatio): > 1 moves the formants up
+    void applyEnvelope(float* magnitudes, float warpRatio) noexcept;
+
+    const float* getEnvelope() const noexcept { return envelope.data(); }
+    int getNumBins() const noexcept { return numBins; }
+
+private:
+    //==============================================================================
+    juce::dsp::FFT* fft = nullptr;
+    int fftSize = 0;
+    int numBins = 0;
+
+    std::vector<float> cepstrum;          // 2 * fftSize, JUCE real-only transform layout
+    std::vector<float> envelope;          // Linear magnitude per bin
+    std::vector<float> inverseEnvelope;
+    std::vector<float> warpedEnvelope;
+};
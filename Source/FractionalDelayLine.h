@@ -0,0 +1,98 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Fractional Delay Line
+
+    Power-of-two ring (index & mask, no modulo) read at a per-sample
+    fractional delay with 4-point (3rd order) Lagrange interpolation.
+
+    Work is done a block at a time: read() produces a run of upcoming
+    outputs from history, then write() appends that run. The read loop has
+    no cross-iteration dependency, so modulated taps (chorus, doubler,
+    tape-style glides) cost the same as a fixed delay. For feedback paths,
+    keep each run no longer than getSafeChunkLength() of its shortest delay.
+*/
+class FractionalDelayLine
+{
+public:
+    //==============================================================================
+    // The newest Lagrange tap sits one sample after the integer delay
+    static constexpr float minDelay = 2.0f;
+
+    // Allocates the ring. Not real-time safe.
+    void prepare(int maxDelaySamples)
+    {
+        maxDelay = static_cast<float>(juce::jmax(static_cast<int>(minDelay), maxDelaySamples));
+
+        const int size = juce::nextPowerOfTwo(static_cast<int>(maxDelay) + 4);
+        buffer.assign(static_cast<size_t>(size), 0.0f);
+        mask = size - 1;
+        writePosition = 0;
+    }
+
+    void reset() noexcept
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        writePosition = 0;
+    }
+
+    float getMaxDelay() const noexcept { return maxDelay; }
+
+    // Longest run read() can produce before any of it has been written
+    static int getSafeChunkLength(float shortestDelay) noexcept
+    {
+        return juce::jmax(1, static_cast<int>(shortestDelay) - 1);
+    }
+
+    //==============================================================================
+    // output[i] = input delayed by delays[i] samples, where i counts the
+    // samples the next write() will append. Needs delays[i] >= i + minDelay.
+    void read(const float* delays, float* output, int numSamples) const noexcept
+    {
+        const float* data = buffer.data();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float delay = juce::jlimit(minDelay, maxDelay, delays[i]);
+            const int wholeDelay = static_cast<int>(delay);
+
+            // Taps at delays wholeDelay - 1 .. wholeDelay + 2, u in [1, 2)
+            const float u = delay - static_cast<float>(wholeDelay) + 1.0f;
+            const float um1 = u - 1.0f;
+            const float um2 = u - 2.0f;
+            const float um3 = u - 3.0f;
+
+            const int newest = writePosition + i - wholeDelay + 1;
+            const float x0 = data[newest & mask];
+            const float x1 = data[(newest - 1) & mask];
+            const float x2 = data[(newest - 2) & mask];
+            const float x3 = data[(newest - 3) & mask];
+
+            output[i] = -um1 * um2 * um3 * (1.0f / 6.0f) * x0
+                      +  u   * um2 * um3 * 0.5f          * x1
+                      -  u   * um1 * um3 * 0.5f          * x2
+                      +  u   * um1 * um2 * (1.0f / 6.0f) * x3;
+        }
+    }
+
+    void write(const float* input, int numSamples) noexcept
+    {
+        float* data = buffer.data();
+
+        for (int i = 0; i < numSamples; ++i)
+            data[(writePosition + i) & mask] = input[i];
+
+        writePosition = (writePosition + numSamples) & mask;
+    }
+
+private:
+    //==============================================================================
+    std::vector<float> buffer;
+    int mask = 0;
+    int writePosition = 0;
+    float maxDelay = minDelay;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+
+//==============================================================================
+/**
+    Fixed-capacity MIDI Voice Pool
+
+    Tracks held notes in a small fixed array, so note handling never
+    allocates and every event costs at most one pass over the slots. When
+    all slots are busy a new note steals the oldest one. It is a plain
+    value type: a block-start snapshot can be copied and replayed per
+    channel without touching the heap.
+*/
+class MidiVoicePool
+{
+public:
+    //==============================================================================
+    static constexpr int capacity = 8;
+
+    struct Voice
+    {
+        int note = -1;              // -1 = free
+        float velocity = 0.0f;      // 0..1
+        std::uint32_t age = 0;      // Higher = started more recently
+
+        bool isActive() const noexcept { return note >= 0; }
+    };
+
+    //==============================================================================
+    void handleMidiEvent(const juce::MidiMessage& message) noexcept
+    {
+        if (message.isNoteOn())
+            noteOn(message.getNoteNumber(), message.getFloatVelocity());
+        else if (message.isNoteOff())
+            noteOff(message.getNoteNumber());
+        else if (message.isAllNotesOff() || message.isAllSoundOff())
+            allNotesOff();
+    }
+
+    void noteOn(int note, float velocity) noexcept
+    {
+        // Retrigger a held note in place, else take a free slot, else steal the oldest
+        Voice* target = findVoice(note);
+
+        if (target == nullptr)
+            target = findVoice(-1);
+
+        if (target == nullptr)
+        {
+            target = &voices[0];
+            for (auto& voice : voices)
+                if (voice.age < target->age)
+                    target = &voice;
+        }
+
+        target->note = note;
+        target->velocity = velocity;
+        target->age = ++ageCounter;
+    }
+
+    void noteOff(int note) noexcept
+    {
+        if (auto* voice = findVoice(note))
+            *voice = Voice();
+    }
+
+    void allNotesOff() noexcept
+    {
+        voices.fill(Voice());
+    }
+
+    //==============================================================================
+    const Voice& getVoice(int index) const noexcept { return voices[static_cast<size_t>(index)]; }
+
+    // Most recently started held note (last-note priority), -1 if none
+    int getLatestNote() const noexcept
+    {
+        const Voice* latest = nullptr;
+        for (const auto& voice : voices)
+            if (voice.isActive() && (latest == nullptr || voice.age > latest->age))
+                latest = &voice;
+
+        return latest != nullptr ? latest->note : -1;
+    }
+
+private:
+    //==============================================================================
+    Voice* findVoice(int note) noexcept
+    {
+        for (auto& voice : voices)
+            if (voice.note == note)
+                return &voice;
+
+        return nullptr;
+    }
+
+    std::array<Voice, capacity> voices {};
+    std::uint32_t ageCounter = 0;
+};
@@ -0,0 +1,140 @@
+#include "NonFiniteGuard.h"
+#include <cstring>
+
+//==============================================================================
+namespace
+{
+    constexpr std::uint32_t exponentMask = 0x7f800000u; // All exponent bits set: Inf or NaN
+    constexpr int numLanes = 8;                         // One AVX register of floats
+
+    inline std::uint32_t floatBits(float value) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline bool isNonFinite(float value) noexcept
+    {
+        return (floatBits(value) & exponentMask) == exponentMask;
+    }
+}
+
+//==============================================================================
+void NonFiniteGuard::prepare(double sampleRate)
+{
+    // 5 ms fades, 50 ms hold
+    fadeStep = 1.0f / juce::jmax(1.0f, static_cast<float>(sampleRate * 0.005));
+    holdSamples = juce::jmax(1, static_cast<int>(sampleRate * 0.05));
+    numRepairedBlocks.store(0, std::memory_order_relaxed);
+
+    reset();
+}
+
+void NonFiniteGuard::reset() noexcept
+{
+    muteGain = 1.0f;
+    holdRemaining = 0;
+}
+
+//==============================================================================
+bool NonFiniteGuard::containsNonFinite(const float* samples, int numSamples) noexcept
+{
+    // Independent per-lane OR accumulators keep the loop free of branches
+    // and cross-iteration dependencies, so it vectorises to and/cmp/or
+    std::uint32_t laneFlags[numLanes] = {};
+    int i = 0;
+
+    for (; i + numLanes <= numSamples; i += numLanes)
+        for (int lane = 0; lane < numLanes; ++lane)
+            laneFlags[lane] |= static_cast<std::uint32_t>((floatBits(samples[i + lane]) & exponentMask) == exponentMask);
+
+    std::uint32_t flags = 0;
+    for (int lane = 0; lane < numLanes; ++lane)
+        flags |= laneFlags[lane];
+
+    for (; i < numSamples; ++i)
+        flags |= static_cast<std::uint32_t>(isNonFinite(samples[i]));
+
+    return flags != 0;
+}
+
+int NonFiniteGuard::replaceNonFinite(float* samples, int numSamples) noexcept
+{
+    int numReplaced = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (isNonFinite(samples[i]))
+        {
+            samples[i] = 0.0f;
+            ++numReplaced;
+        }
+    }
+
+    return numReplaced;
+}
+
+//==============================================================================
+bool NonFiniteGuard::process(juce::AudioBuffer<float>& buffer) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    bool blockHadNonFinite = false;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        float* channelData = buffer.getWritePointer(channel);
+
+        // Repair only channels that need it; the clean path is read-only
+        if (containsNonFinite(channelData, numSamples))
+        {
+            replaceNonFinite(channelData, numSamples);
+            blockHadNonFinite = true;
+        }
+    }
+
+    if (blockHadNonFinite)
+        numRepairedBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    if (getPolicy() == Policy::muteWithFade)
+        applyMuteGain(buffer, blockHadNonFinite);
+    else
+        reset();
+
+    return blockHadNonFinite;
+}
+
+void NonFiniteGuard::applyMuteGain(juce::AudioBuffer<float>& buffer, bool blockHadNonFinite) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (blockHadNonFinite)
+        holdRemaining = holdSamples;
+
+    // Fully open and nothing pending: leave the block untouched
+    if (holdRemaining <= 0 && muteGain >= 1.0f)
+        return;
+
+    const int numChannels = buffer.getNumChannels();
+    float* const* channelData = buffer.getArrayOfWritePointers();
+    float gain = muteGain;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Fade out while holding, fade back in once the hold has run out
+        if (holdRemaining > 0)
+        {
+            gain = juce::jmax(0.0f, gain - fadeStep);
+            --holdRemaining;
+        }
+        else
+        {
+            gain = juce::jmin(1.0f, gain + fadeStep);
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            channelData[channel][i] *= gain;
+    }
+
+    muteGain = gain;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdint>
+
+//==============================================================================
+/**
+    Non-finite Input Guard
+
+    Scans each channel once for NaN/Inf with a branch-free exponent bit-mask
+    reduction (auto-vectorised: no per-sample isnan/isinf calls). Clean
+    blocks cost that one read-only pass. When a bad sample turns up, only
+    the affected channel is repaired, according to the policy:
+
+    - sanitize:     replace the non-finite samples with silence, keep the rest
+    - muteWithFade: also ramp the whole output down over a few milliseconds,
+                    hold it muted briefly, then ramp back in
+*/
+class NonFiniteGuard
+{
+public:
+    //==============================================================================
+    enum class Policy
+    {
+        sanitize = 0,
+        muteWithFade
+    };
+
+    //==============================================================================
+    void prepare(double sampleRate);
+    void reset() noexcept;
+
+    // Returns true if the block contained non-finite samples
+    bool process(juce::AudioBuffer<float>& buffer) noexcept;
+
+    void setPolicy(Policy newPolicy) noexcept { policy.store(newPolicy, std::memory_order_relaxed); }
+    Policy getPolicy() const noexcept { return policy.load(std::memory_order_relaxed); }
+
+    // Blocks that needed repairing since prepare() (any thread)
+    std::uint32_t getNumRepairedBlocks() const noexcept { return numRepairedBlocks.load(std::memory_order_relaxed); }
+
+    //==============================================================================
+    static bool containsNonFinite(const float* samples, int numSamples) noexcept;
+    static int replaceNonFinite(float* samples, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    void applyMuteGain(juce::AudioBuffer<float>& buffer, bool blockHadNonFinite) noexcept;
+
+    std::atomic<Policy> policy { Policy::muteWithFade };
+    std::atomic<std::uint32_t> numRepairedBlocks { 0 };
+
+    // Mute-with-fade state (audio thread)
+    float muteGain = 1.0f;
+    float fadeStep = 1.0f / 256.0f;   // Gain change per sample
+    int holdSamples = 2048;           // Stay muted this long after the last bad block
+    int holdRemaining = 0;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+    FFT Plan Cache
+    
+    Owns one juce::dsp::FFT per order. Plans are created in prepare() on the
+    message thread; the audio thread only looks them up, so no twiddle
+    tables are built and nothing is allocated while processing.
+*/
+class FFTPlanCache
+{
+public:
+    //==============================================================================
+    static constexpr int maxOrder = 16; // 65536 points
+    
+    // Creates the plan for an order if needed. Not real-time safe.
+    juce::dsp::FFT& prepare(int order)
+    {
+        jassert(order >= 0 && order <= maxOrder);
+        order = juce::jlimit(0, maxOrder, order);
+        
+        auto& plan = plans[static_cast<size_t>(order)];
+        if (plan == nullptr)
+            plan = std::make_unique<juce::dsp::FFT>(order);
+        
+        return *plan;
+    }
+    
+    // Returns a prepared plan, or nullptr if prepare() was never called for it
+    juce::dsp::FFT* get(int order) const noexcept
+    {
+        if (order < 0 || order > maxOrder)
+            return nullptr;
+        
+        jassert(plans[static_cast<size_t>(order)] != nullptr); // Plan must be created in prepare()
+        return plans[static_cast<size_t>(order)].get();
+    }
+    
+    void clear()
+    {
+        for (auto& plan : plans)
+            plan.reset();
+    }
+    
+private:
+    std::array<std::unique_ptr<juce::dsp::FFT>, maxOrder + 1> plans;
+};
+
+//==============================================================================
+/**
+    Scratch Arena
+    
+    A block of floats reserved in prepare() and handed out on the audio
+    thread with a bump pointer. Use ScopedFrame to give the space back when
+    a processing step returns; frames nest like a stack.
+*/
+class ScratchArena
+{
+public:
+    //==============================================================================
+    // Reserves capacity. Not real-time safe.
+    void prepare(size_t numFloats)
+    {
+        storage.assign(numFloats, 0.0f);
+        position = 0;
+    }
+    
+    // Returns zeroed space for numFloats, 64-byte granular, or nullptr when
+    // the arena was sized too small in prepare()
+    float* allocate(size_t numFloats) noexcept
+    {
+        const size_t rounded = (numFloats + alignmentFloats - 1) & ~(alignmentFloats - 1);
+        
+        if (position + rounded > storage.size())
+        {
+            jassertfalse; // Scratch arena exhausted - size it larger in prepare()
+            return nullptr;
+        }
+        
+        float* block = storage.data() + position;
+        position += rounded;
+        std::fill(block, block + numFloats, 0.0f);
+        return block;
+    }
+    
+    size_t getMark() const noexcept { return position; }
+    void resetToMark(size_t mark) noexcept { position = juce::jmin(mark, position); }
+    size_t getCapacity() const noexcept { return storage.size(); }
+    
+    //==============================================================================
+    class ScopedFrame
+    {
+    public:
+        explicit ScopedFrame(ScratchArena& arenaToUse) noexcept
+            : arena(arenaToUse), mark(arenaToUse.getMark()) {}
+        
+        ~ScopedFrame() { arena.resetToMark(mark); }
+        
+        float* allocate(size_t numFloats) noexcept { return arena.allocate(numFloats); }
+        
+    private:
+        ScratchArena& arena;
+        size_t mark;
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedFrame)
+    };
+    
+private:
+    static constexpr size_t alignmentFloats = 16;
+    
+    std::vector<float> storage;
+    size_t position = 0;
+};
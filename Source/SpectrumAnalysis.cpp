@@ -0,0 +1,95 @@
+#include "SpectrumAnalysis.h"
+
+//==============================================================================
+SpectrumAnalysis::SpectrumAnalysis()
+{
+    fifoBuffer.resize(fifoCapacity, 0.0f);
+    history.resize(fftSize, 0.0f);
+    window.resize(fftSize, 0.0f);
+    fftData.resize(fftSize * 2, 0.0f);
+    magnitudes.resize(numBins, 0.0f);
+    
+    // Create Hann window
+    for (int i = 0; i < fftSize; ++i)
+    {
+        window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / (fftSize - 1)));
+    }
+}
+
+//==============================================================================
+void SpectrumAnalysis::pushSamples(const float* samples, int numSamples) noexcept
+{
+    if (samples == nullptr || numSamples <= 0)
+        return;
+    
+    // Only the newest samples matter to the display
+    numSamples = juce::jmin(numSamples, fifoCapacity - 1);
+    
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    
+    if (size1 > 0)
+        std::copy(samples, samples + size1, fifoBuffer.data() + start1);
+    
+    if (size2 > 0)
+        std::copy(samples + size1, samples + size1 + size2, fifoBuffer.data() + start2);
+    
+    fifo.finishedWrite(size1 + size2);
+    
+    // Only the consumer may discard the oldest data, so just tell it
+    if (size1 + size2 < numSamples)
+        samplesDropped.store(true, std::memory_order_release);
+}
+
+//==============================================================================
+bool SpectrumAnalysis::computeSpectrum()
+{
+    const int numReady = fifo.getNumReady();
+    if (numReady <= 0)
+        return false;
+    
+    // The FIFO filled up while nobody was reading (editor closed): what it
+    // holds is old audio, so drop it and wait for fresh samples
+    if (samplesDropped.exchange(false, std::memory_order_acquire))
+    {
+        fifo.finishedRead(numReady);
+        std::fill(history.begin(), history.end(), 0.0f);
+        historyPosition = 0;
+        return false;
+    }
+    
+    // Move everything that arrived into the history ring
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numReady, start1, size1, start2, size2);
+    
+    auto appendToHistory = [this](const float* source, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            history[historyPosition] = source[i];
+            historyPosition = (historyPosition + 1) % fftSize;
+        }
+    };
+    
+    appendToHistory(fifoBuffer.data() + start1, size1);
+    appendToHistory(fifoBuffer.data() + start2, size2);
+    fifo.finishedRead(size1 + size2);
+    
+    // Apply window to the latest fftSize samples, oldest first
+    for (int i = 0; i < fftSize; ++i)
+    {
+        fftData[i] = history[(historyPosition + i) % fftSize] * window[i];
+        fftData[i + fftSize] = 0.0f;
+    }
+    
+    // Frequency-only transform leaves magnitudes in fftData[0 .. numBins]; convert to dB
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+    
+    for (int i = 0; i < numBins; ++i)
+    {
+        float db = juce::Decibels::gainToDecibels(fftData[i] + 1e-10f);
+        magnitudes[i] = juce::jlimit(0.0f, 1.0f, (db + 60.0f) / 60.0f);
+    }
+    
+    return true;
+}
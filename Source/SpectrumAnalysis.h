@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <atomic>
+
+//==============================================================================
+/**
+    Spectrum Analysis (audio thread -> editor handoff)
+    
+    The audio thread only copies samples into a single-producer /
+    single-consumer AbstractFifo. The consumer (the editor's timer) drains
+    it and runs the windowed FFT and dB conversion on its own thread, so
+    the real-time path never touches the FFT and no state is shared
+    without synchronisation.
+*/
+class SpectrumAnalysis
+{
+public:
+    //==============================================================================
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;   // 1024 point FFT
+    static constexpr int numBins = fftSize / 2;
+    
+    // Everything is allocated here, so neither side allocates later
+    SpectrumAnalysis();
+    
+    //==============================================================================
+    // Audio thread: samples that don't fit (no consumer running) are dropped
+    // and flagged; the consumer then throws away the stale backlog
+    void pushSamples(const float* samples, int numSamples) noexcept;
+    
+    //==============================================================================
+    // Consumer thread only
+    bool computeSpectrum(); // Drains the FIFO; true if the magnitudes changed
+    const std::vector<float>& getMagnitudes() const { return magnitudes; } // 0..1, numBins values
+    
+private:
+    //==============================================================================
+    static constexpr int fifoCapacity = 1 << 16;    // > 300 ms at 192 kHz
+    
+    // Producer/consumer handoff
+    juce::AbstractFifo fifo { fifoCapacity };
+    std::vector<float> fifoBuffer;
+    std::atomic<bool> samplesDropped { false };     // Set when the FIFO was full
+    
+    // Consumer-side analysis state
+    std::vector<float> history;                     // Last fftSize samples (ring)
+    int historyPosition = 0;
+    juce::dsp::FFT fft { fftOrder };
+    std::vector<float> window;
+    std::vector<float> fftData;
+    std::vector<float> magnitudes;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalysis)
+};
@@ -0,0 +1,140 @@
+#include "StageProfiler.h"
+
+//==============================================================================
+const char* StageProfiler::getStageName(Stage stage) noexcept
+{
+    switch (stage)
+    {
+        case pitchTuner:       return "Pitch Tuner";
+        case doubler:          return "Doubler";
+        case harmony:          return "Harmony";
+        case delay:            return "Delay";
+        case reverb:           return "Reverb";
+        case dynamicEQ:        return "Dynamic EQ";
+        case compressor:       return "Compressor";
+        case spectrum:         return "Spectrum";
+        case total:            return "Total";
+        case numStages:        break;
+    }
+
+    return "";
+}
+
+#if VOCALAI_ENABLE_PROFILING
+
+//==============================================================================
+void StageProfiler::prepare(double sampleRate) noexcept
+{
+    ticksPerSample = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / juce::jmax(1.0, sampleRate);
+    clearCounters();
+}
+
+void StageProfiler::beginBlock(int numSamples) noexcept
+{
+    if (resetRequested.exchange(false, std::memory_order_acquire))
+        clearCounters();
+
+    deadlineTicks = juce::jmax(1.0, ticksPerSample * numSamples);
+    blockTicks.fill(0);
+}
+
+void StageProfiler::endBlock() noexcept
+{
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        auto& stageCounters = counters[static_cast<size_t>(stage)];
+        const double load = static_cast<double>(blockTicks[static_cast<size_t>(stage)]) / deadlineTicks;
+        const auto loadPermyriad = static_cast<std::uint32_t>(juce::jmin(load * 10000.0, 4.0e9));
+        const int bin = juce::jmin(numHistogramBins - 1, static_cast<int>(load * 100.0));
+
+        // Single writer, so relaxed load/store pairs are enough
+        stageCounters.histogram[static_cast<size_t>(bin)].fetch_add(1, std::memory_order_relaxed);
+        stageCounters.loadSumPermyriad.fetch_add(loadPermyriad, std::memory_order_relaxed);
+
+        if (loadPermyriad > stageCounters.maxLoadPermyriad.load(std::memory_order_relaxed))
+            stageCounters.maxLoadPermyriad.store(loadPermyriad, std::memory_order_relaxed);
+
+        stageCounters.numBlocks.fetch_add(1, std::memory_order_release);
+    }
+}
+
+StageProfiler::ScopedStage::ScopedStage(StageProfiler* profilerToUse, Stage stageToTime) noexcept
+    : profiler(profilerToUse),
+      stage(stageToTime),
+      startTicks(profilerToUse != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+{
+}
+
+StageProfiler::ScopedStage::~ScopedStage()
+{
+    if (profiler != nullptr)
+        profiler->blockTicks[static_cast<size_t>(stage)] += juce::Time::getHighResolutionTicks() - startTicks;
+}
+
+//==============================================================================
+StageProfiler::StageStats StageProfiler::getStats(Stage stage) const noexcept
+{
+    StageStats stats;
+
+    if (stage < 0 || stage >= numStages)
+        return stats;
+
+    const auto& stageCounters = counters[static_cast<size_t>(stage)];
+    stats.numBlocks = stageCounters.numBlocks.load(std::memory_order_acquire);
+
+    if (stats.numBlocks == 0)
+        return stats;
+
+    stats.meanPercent = static_cast<float>(stageCounters.loadSumPermyriad.load(std::memory_order_relaxed)
+                                           / 100.0 / static_cast<double>(stats.numBlocks));
+    stats.maxPercent = static_cast<float>(stageCounters.maxLoadPermyriad.load(std::memory_order_relaxed)) / 100.0f;
+
+    // First bin at which 99% of the blocks are accounted for (upper bin edge)
+    const auto target = static_cast<std::uint64_t>(std::ceil(0.99 * static_cast<double>(stats.numBlocks)));
+    std::uint64_t cumulative = 0;
+
+    for (int bin = 0; bin < numHistogramBins; ++bin)
+    {
+        cumulative += stageCounters.histogram[static_cast<size_t>(bin)].load(std::memory_order_relaxed);
+
+        if (cumulative >= target)
+        {
+            stats.p99Percent = juce::jmin(static_cast<float>(bin + 1), stats.maxPercent);
+            break;
+        }
+    }
+
+    return stats;
+}
+
+void StageProfiler::resetStats() noexcept
+{
+    resetRequested.store(true, std::memory_order_release);
+}
+
+void StageProfiler::clearCounters() noexcept
+{
+    for (auto& stageCounters : counters)
+    {
+        stageCounters.numBlocks.store(0, std::memory_order_relaxed);
+        stageCounters.loadSumPermyriad.store(0, std::memory_order_relaxed);
+        stageCounters.maxLoadPermyriad.store(0, std::memory_order_relaxed);
+
+        for (auto& bin : stageCounters.histogram)
+            bin.store(0, std::memory_order_relaxed);
+    }
+}
+
+#else
+
+//==============================================================================
+// Profiling compiled out: everything is a no-op
+void StageProfiler::prepare(double) noexcept {}
+void StageProfiler::beginBlock(int) noexcept {}
+void StageProfiler::endBlock() noexcept {}
+StageProfiler::ScopedStage::ScopedStage(StageProfiler*, Stage) noexcept {}
+StageProfiler::ScopedStage::~ScopedStage() {}
+StageProfiler::StageStats StageProfiler::getStats(Stage) const noexcept { return {}; }
+void StageProfiler::resetStats() noexcept {}
+
+#endif
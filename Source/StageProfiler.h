@@ -0,0 +1,130 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Per-stage timing in processBlock. On in debug builds; define to 1 to
+// profile a release build, or to 0 to compile every counter out.
+#ifndef VOCALAI_ENABLE_PROFILING
+ #if JUCE_DEBUG
+  #define VOCALAI_ENABLE_PROFILING 1
+ #else
+  #define VOCALAI_ENABLE_PROFILING 0
+ #endif
+#endif
+
+//==============================================================================
+/**
+    Hot-path Stage Profiler
+
+    The audio thread times each stage with high-resolution ticks,
+    accumulates them over the block and publishes the block's load (stage
+    time as a fraction of the block deadline) into lock-free atomics. The
+    editor polls mean and p99 load per stage.
+*/
+class StageProfiler
+{
+public:
+    //==============================================================================
+    enum Stage
+    {
+        pitchTuner = 0,
+        doubler,
+        harmony,
+        delay,
+        reverb,
+        dynamicEQ,
+        compressor,
+        spectrum,
+        total,              // Whole processBlock
+        numStages
+    };
+
+    struct StageStats
+    {
+        float meanPercent = 0.0f;  // Of the block deadline
+        float p99Percent = 0.0f;
+        float maxPercent = 0.0f;
+        std::uint64_t numBlocks = 0;
+    };
+
+    static constexpr bool isEnabled() { return VOCALAI_ENABLE_PROFILING != 0; }
+    static const char* getStageName(Stage stage) noexcept;
+
+    //==============================================================================
+    // Audio thread
+    void prepare(double sampleRate) noexcept;
+    void beginBlock(int numSamples) noexcept;
+    void endBlock() noexcept;
+
+    // beginBlock()/endBlock() around a scope, so early returns still publish
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock(StageProfiler& profilerToUse, int numSamples) noexcept
+            : profiler(profilerToUse) { profiler.beginBlock(numSamples); }
+        
+        ~ScopedBlock() { profiler.endBlock(); }
+        
+    private:
+        StageProfiler& profiler;
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+    
+    class ScopedStage
+    {
+    public:
+        ScopedStage(StageProfiler* profilerToUse, Stage stageToTime) noexcept;
+        ~ScopedStage();
+
+    private:
+       #if VOCALAI_ENABLE_PROFILING
+        StageProfiler* profiler;
+        Stage stage;
+        juce::int64 startTicks;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+
+    //==============================================================================
+    // Any thread
+    StageStats getStats(Stage stage) const noexcept;
+    void resetStats() noexcept; // Applied by the audio thread at the next block
+
+private:
+   #if VOCALAI_ENABLE_PROFILING
+    //==============================================================================
+    // Load histogram in 1% bins up to 200% of the deadline (last bin: overflow)
+    static constexpr int numHistogramBins = 201;
+
+    struct StageCounters
+    {
+        std::atomic<std::uint64_t> numBlocks { 0 };
+        std::atomic<std::uint64_t> loadSumPermyriad { 0 }; // Sum of load in 0.01% units
+        std::atomic<std::uint32_t> maxLoadPermyriad { 0 };
+        std::array<std::atomic<std::uint32_t>, numHistogramBins> histogram {};
+    };
+
+    void clearCounters() noexcept;
+
+    std::array<StageCounters, numStages> counters;
+    std::array<juce::int64, numStages> blockTicks {};  // Audio thread only
+    double ticksPerSample = 0.0;
+    double deadlineTicks = 1.0;
+    std::atomic<bool> resetRequested { false };
+   #endif
+};
+
+#if VOCALAI_ENABLE_PROFILING
+ #define VOCALAI_PROFILE_BLOCK(profiler, numSamples) \
+    StageProfiler::ScopedBlock JUCE_JOIN_MACRO(profiledBlock_, __LINE__) (profiler, numSamples)
+ #define VOCALAI_PROFILE_STAGE(profiler, stage) \
+    StageProfiler::ScopedStage JUCE_JOIN_MACRO(profiledStage_, __LINE__) (profiler, StageProfiler::stage)
+#else
+ #define VOCALAI_PROFILE_BLOCK(profiler, numSamples)
+ #define VOCALAI_PROFILE_STAGE(profiler, stage)
+#endif
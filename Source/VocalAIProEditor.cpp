@@ -1,5 +1,6 @@
 #include "VocalAIProEditor.h"
 #include "AIPitchTuner.h"
+#include "VocalEffects.h"
 
 //==============================================================================
 VocalAIProEditor::VocalAIProEditor (VocalAIProPlugin& p)
@@ -46,6 +47,10 @@ VocalAIProEditor::VocalAIProEditor (VocalAIProPlugin& p)
     addAndMakeVisible(reverbAmountKnob);
     setupLabel(reverbAmountLabel, "Reverb");
     
+    setupButton(loadImpulseResponseButton);
+    loadImpulseResponseButton.setTooltip("Load an impulse response for the convolution reverb");
+    addAndMakeVisible(loadImpulseResponseButton);
+    
     // Delay
     delayTimeKnob.setRange(0.0, 2000.0, 1.0);
     delayTimeKnob.setValue(250.0);
@@ -104,6 +109,8 @@ VocalAIProEditor::VocalAIProEditor (VocalAIProPlugin& p)
     setupLabel(currentPitchLabel, "Pitch: -- Hz");
     setupLabel(pitchConfidenceLabel, "Confidence: --%");
     setupLabel(statusLabel, "Status: Ready");
+    setupLabel(performanceLabel, "DSP: --");
+    performanceLabel.setVisible(StageProfiler::isEnabled());
     
     //==============================================================================
     // Setup Branding
@@ -172,6 +179,7 @@ VocalAIProEditor::VocalAIProEditor (VocalAIProPlugin& p)
     pitchSpeedKnob.addListener(this);
     pitchCorrectionEnabledButton.addListener(this);
     reverbAmountKnob.addListener(this);
+    loadImpulseResponseButton.addListener(this);
     delayTimeKnob.addListener(this);
     delayFeedbackKnob.addListener(this);
     harmonyAmountKnob.addListener(this);
@@ -256,6 +264,8 @@ void VocalAIProEditor::resized()
     // Reverb
     auto reverbArea = vocalEffectsContent.removeFromTop(50);
     reverbAmountLabel.setBounds(reverbArea.removeFromLeft(80));
+    loadImpulseResponseButton.setBounds(reverbArea.removeFromRight(90).reduced(0, 12));
+    reverbArea.removeFromRight(CONTROL_SPACING);
     reverbAmountKnob.setBounds(reverbArea);
     
     // Delay
@@ -305,6 +315,9 @@ void VocalAIProEditor::resized()
     pitchConfidenceLabel.setBounds(visualContent.removeFromTop(25));
     statusLabel.setBounds(visualContent.removeFromTop(25));
     
+    if (StageProfiler::isEnabled())
+        performanceLabel.setBounds(visualContent.removeFromTop(25));
+    
     // Spectrum analyzer
     if (spectrumAnalyzer)
         spectrumAnalyzer->setBounds(visualContent);
@@ -354,7 +367,30 @@ void VocalAIProEditor::timerCallback()
 void VocalAIProEditor::buttonClicked(juce::Button* button)
 {
     // Preset buttons removed - using DAW preset system
-    juce::ignoreUnused(button);
+    if (button == &loadImpulseResponseButton)
+        chooseImpulseResponse();
+}
+
+void VocalAIProEditor::chooseImpulseResponse()
+{
+    impulseResponseChooser = std::make_unique<juce::FileChooser>(
+        "Load Impulse Response", audioProcessor.getReverbImpulseResponseFile(), "*.wav;*.aif;*.aiff;*.flac");
+    
+    const auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+    
+    impulseResponseChooser->launchAsync(flags, [this](const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        if (! file.existsAsFile())
+            return;
+        
+        // Decoding and transforming happen off the audio thread; switch to
+        // convolution so the new IR is heard once it is ready
+        audioProcessor.loadReverbImpulseResponse(file);
+        
+        if (auto* parameter = audioProcessor.getValueTreeState().getParameter("reverbMode"))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(static_cast<float>(VocalEffects::reverbModeConvolution)));
+    });
 }
 
 void VocalAIProEditor::sliderValueChanged(juce::Slider* slider)
@@ -451,12 +487,40 @@ void VocalAIProEditor::updateVisualFeedback()
         }
     }
     
-    // Update spectrum analyzer
+    // DSP load: whole block plus the heaviest stage by p99
+    if (StageProfiler::isEnabled())
+    {
+        auto& profiler = audioProcessor.getProfiler();
+        const auto totalStats = profiler.getStats(StageProfiler::total);
+        
+        auto heaviestStage = StageProfiler::pitchTuner;
+        auto heaviestStats = profiler.getStats(heaviestStage);
+        
+        for (int stage = StageProfiler::pitchTuner; stage < StageProfiler::total; ++stage)
+        {
+            const auto stats = profiler.getStats(static_cast<StageProfiler::Stage>(stage));
+            
+            if (stats.p99Percent > heaviestStats.p99Percent)
+            {
+                heaviestStage = static_cast<StageProfiler::Stage>(stage);
+                heaviestStats = stats;
+            }
+        }
+        
+        performanceLabel.setText("DSP: " + juce::String(totalStats.meanPercent, 1) + "% avg, "
+                                 + juce::String(totalStats.p99Percent, 1) + "% p99 ("
+                                 + StageProfiler::getStageName(heaviestStage) + " "
+                                 + juce::String(heaviestStats.p99Percent, 1) + "%)",
+                                 juce::dontSendNotification);
+    }
+    
+    // Update spectrum analyzer (drains the audio thread's samples and runs the FFT here)
     if (spectrumAnalyzer)
     {
-        const auto& magnitudes = audioProcessor.getSpectrumMagnitudes();
-        if (!magnitudes.empty())
+        auto& spectrumAnalysis = audioProcessor.getSpectrumAnalysis();
+        if (spectrumAnalysis.computeSpectrum())
         {
+            const auto& magnitudes = spectrumAnalysis.getMagnitudes();
             spectrumAnalyzer->updateSpectrum(magnitudes.data(), static_cast<int>(magnitudes.size()));
         }
     }
@@ -56,6 +56,8 @@ private:
     // Reverb Controls
     CustomKnob reverbAmountKnob;
     juce::Label reverbAmountLabel;
+    juce::TextButton loadImpulseResponseButton { "Load IR..." };
+    std::unique_ptr<juce::FileChooser> impulseResponseChooser;
     
     // Delay Controls
     CustomKnob delayTimeKnob;
@@ -88,6 +90,7 @@ private:
     juce::Label currentPitchLabel;
     juce::Label pitchConfidenceLabel;
     juce::Label statusLabel;
+    juce::Label performanceLabel;  // Stage profiler readout (profiling builds only)
     
     // Real-time Spectrum Analyzer
     class SpectrumAnalyzer : public juce::Component, public juce::Timer
@@ -167,6 +170,9 @@ private:
     // Advanced Visual Components
     void createAdvancedVisualComponents();
     
+    // Convolution reverb file picker
+    void chooseImpulseResponse();
+    
     //==============================================================================
     // Constants
     static constexpr int WINDOW_WIDTH = 800;
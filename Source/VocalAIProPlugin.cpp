@@ -2,6 +2,7 @@
 #include "VocalAIProEditor.h"
 #include "AIPitchTuner.h"
 #include "VocalEffects.h"
+#include "AudioThreadGuard.h"
 
 //==============================================================================
 VocalAIProPlugin::VocalAIProPlugin()
@@ -19,18 +20,44 @@ VocalAIProPlugin::VocalAIProPlugin()
     pitchCorrectionParam = parameters.getRawParameterValue("pitchCorrection");
     pitchSpeedParam = parameters.getRawParameterValue("pitchSpeed");
     pitchCorrectionEnabledParam = parameters.getRawParameterValue("pitchCorrectionEnabled");
+    pitchDetectorParam = parameters.getRawParameterValue("pitchDetector");
+    pitchEngineParam = parameters.getRawParameterValue("pitchEngine");
+    formantPreserveParam = parameters.getRawParameterValue("formantPreserve");
+    formantShiftParam = parameters.getRawParameterValue("formantShift");
+    pitchStereoLinkParam = parameters.getRawParameterValue("pitchStereoLink");
+    midiModeParam = parameters.getRawParameterValue("midiMode");
     
     // Initialize Vocal Effects Parameters
     reverbAmountParam = parameters.getRawParameterValue("reverbAmount");
+    reverbModeParam = parameters.getRawParameterValue("reverbMode");
     delayTimeParam = parameters.getRawParameterValue("delayTime");
     delayFeedbackParam = parameters.getRawParameterValue("delayFeedback");
+    delaySyncParam = parameters.getRawParameterValue("delaySync");
+    delayDivisionParam = parameters.getRawParameterValue("delayDivision");
+    delayModeParam = parameters.getRawParameterValue("delayMode");
     harmonyAmountParam = parameters.getRawParameterValue("harmonyAmount");
     harmonyVoicesParam = parameters.getRawParameterValue("harmonyVoices");
+    compressorThresholdParam = parameters.getRawParameterValue("compressorThreshold");
+    compressorRatioParam = parameters.getRawParameterValue("compressorRatio");
+    compressorKneeParam = parameters.getRawParameterValue("compressorKnee");
+    compressorMakeupParam = parameters.getRawParameterValue("compressorMakeup");
+    compressorLookAheadParam = parameters.getRawParameterValue("compressorLookAhead");
+    compressorStereoLinkParam = parameters.getRawParameterValue("compressorStereoLink");
+    
+    for (int band = 0; band < DynamicEQ::numBands; ++band)
+    {
+        const auto b = static_cast<size_t>(band);
+        eqBandFrequencyParams[b] = parameters.getRawParameterValue(getEQBandParameterID(band, "Frequency"));
+        eqBandGainParams[b] = parameters.getRawParameterValue(getEQBandParameterID(band, "Gain"));
+        eqBandThresholdParams[b] = parameters.getRawParameterValue(getEQBandParameterID(band, "Threshold"));
+        eqBandRangeParams[b] = parameters.getRawParameterValue(getEQBandParameterID(band, "Range"));
+    }
     
     // Initialize Master Parameters
     inputGainParam = parameters.getRawParameterValue("inputGain");
     outputGainParam = parameters.getRawParameterValue("outputGain");
     bypassParam = parameters.getRawParameterValue("bypass");
+    inputGuardPolicyParam = parameters.getRawParameterValue("inputGuardPolicy");
     
     // Initialize AI Components
     aiPitchTuner = std::make_unique<AIPitchTuner>();
@@ -40,21 +67,47 @@ VocalAIProPlugin::VocalAIProPlugin()
     parameters.addParameterListener("pitchCorrection", this);
     parameters.addParameterListener("pitchSpeed", this);
     parameters.addParameterListener("pitchCorrectionEnabled", this);
+    parameters.addParameterListener("pitchDetector", this);
+    parameters.addParameterListener("pitchEngine", this);
+    parameters.addParameterListener("formantPreserve", this);
+    parameters.addParameterListener("formantShift", this);
+    parameters.addParameterListener("pitchStereoLink", this);
+    parameters.addParameterListener("midiMode", this);
     parameters.addParameterListener("reverbAmount", this);
+    parameters.addParameterListener("reverbMode", this);
     parameters.addParameterListener("delayTime", this);
     parameters.addParameterListener("delayFeedback", this);
+    parameters.addParameterListener("delaySync", this);
+    parameters.addParameterListener("delayDivision", this);
+    parameters.addParameterListener("delayMode", this);
     parameters.addParameterListener("harmonyAmount", this);
     parameters.addParameterListener("harmonyVoices", this);
+    parameters.addParameterListener("compressorThreshold", this);
+    parameters.addParameterListener("compressorRatio", this);
+    parameters.addParameterListener("compressorKnee", this);
+    parameters.addParameterListener("compressorMakeup", this);
+    parameters.addParameterListener("compressorLookAhead", this);
+    parameters.addParameterListener("compressorStereoLink", this);
+    
+    for (int band = 0; band < DynamicEQ::numBands; ++band)
+        for (auto* suffix : { "Frequency", "Gain", "Threshold", "Range" })
+            parameters.addParameterListener(getEQBandParameterID(band, suffix), this);
+    
     parameters.addParameterListener("inputGain", this);
     parameters.addParameterListener("outputGain", this);
     parameters.addParameterListener("bypass", this);
+    parameters.addParameterListener("inputGuardPolicy", this);
     
     // Initialize presets after parameters are ready
     initializePresets();
+    
+    // setLatencySamples notifies the host, so it never runs inside processBlock
+    startTimer(100);
 }
 
 VocalAIProPlugin::~VocalAIProPlugin()
 {
+    stopTimer();
     // std::unique_ptr automatically handles cleanup
 }
 
@@ -77,12 +130,40 @@ juce::AudioProcessorValueTreeState::ParameterLayout VocalAIProPlugin::createPara
     params.push_back(std::make_unique<juce::AudioParameterBool>(
         "pitchCorrectionEnabled", "Pitch Correction Enabled", true));
     
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "pitchDetector", "Pitch Detector",
+        juce::StringArray { "YIN", "Autocorrelation" }, 0));
+    
+    // Order matches AIPitchTuner::PitchShiftEngine
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "pitchEngine", "Pitch Engine",
+        juce::StringArray { "Phase Vocoder", "PSOLA (Tracking)" }, 0));
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "formantPreserve", "Formant Preserve", true));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "formantShift", "Formant Shift",
+        juce::NormalisableRange<float>(-12.0f, 12.0f, 0.1f), 0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("st")));
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "pitchStereoLink", "Pitch Stereo Link", false));
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "midiMode", "MIDI Mode", false));
+    
     // Vocal Effects Parameters
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "reverbAmount", "Reverb Amount", 
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 0.0f,
         juce::AudioParameterFloatAttributes().withLabel("%")));
     
+    // Order matches VocalEffects::ReverbMode
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "reverbMode", "Reverb Mode",
+        juce::StringArray { "Algorithmic", "Convolution" }, 0));
+    
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "delayTime", "Delay Time", 
         juce::NormalisableRange<float>(0.0f, 2000.0f, 1.0f), 250.0f,
@@ -93,6 +174,20 @@ juce::AudioProcessorValueTreeState::ParameterLayout VocalAIProPlugin::createPara
         juce::NormalisableRange<float>(0.0f, 95.0f, 0.1f), 30.0f,
         juce::AudioParameterFloatAttributes().withLabel("%")));
     
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "delaySync", "Delay Sync", false));
+    
+    // Order matches VocalEffects::DelayDivision
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "delayDivision", "Delay Division",
+        juce::StringArray { "1/2", "1/4", "1/4 Dotted", "1/4 Triplet",
+                            "1/8", "1/8 Dotted", "1/8 Triplet", "1/16" }, 4));
+    
+    // Order matches VocalEffects::DelayMode
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "delayMode", "Delay Mode",
+        juce::StringArray { "Normal", "Ping-Pong", "Wide" }, 0));
+    
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "harmonyAmount", "Harmony Amount", 
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 0.0f,
@@ -101,6 +196,62 @@ juce::AudioProcessorValueTreeState::ParameterLayout VocalAIProPlugin::createPara
     params.push_back(std::make_unique<juce::AudioParameterInt>(
         "harmonyVoices", "Harmony Voices", 1, 8, 2));
     
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "compressorThreshold", "Compressor Threshold",
+        juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f), -10.0f,
+        juce::AudioParameterFloatAttributes().withLabel("dB")));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "compressorRatio", "Compressor Ratio",
+        juce::NormalisableRange<float>(1.0f, 20.0f, 0.1f, 0.5f), 3.0f,
+        juce::AudioParameterFloatAttributes().withLabel(":1")));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "compressorKnee", "Compressor Knee",
+        juce::NormalisableRange<float>(0.0f, 24.0f, 0.1f), 6.0f,
+        juce::AudioParameterFloatAttributes().withLabel("dB")));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "compressorMakeup", "Compressor Makeup",
+        juce::NormalisableRange<float>(-12.0f, 24.0f, 0.1f), 0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("dB")));
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "compressorLookAhead", "Compressor Look-Ahead",
+        juce::NormalisableRange<float>(0.0f, 10.0f, 0.1f), 0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+    
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "compressorStereoLink", "Compressor Stereo Link", true));
+    
+    // Dynamic EQ bands; gain and range at 0 dB leave a band flat
+    static constexpr float eqDefaultFrequencies[DynamicEQ::numBands] = { 150.0f, 600.0f, 2500.0f, 7500.0f };
+    
+    for (int band = 0; band < DynamicEQ::numBands; ++band)
+    {
+        const juce::String name = "EQ Band " + juce::String(band + 1);
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(
+            getEQBandParameterID(band, "Frequency"), name + " Frequency",
+            juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f), eqDefaultFrequencies[band],
+            juce::AudioParameterFloatAttributes().withLabel("Hz")));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(
+            getEQBandParameterID(band, "Gain"), name + " Gain",
+            juce::NormalisableRange<float>(-12.0f, 12.0f, 0.1f), 0.0f,
+            juce::AudioParameterFloatAttributes().withLabel("dB")));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(
+            getEQBandParameterID(band, "Threshold"), name + " Threshold",
+            juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f), -20.0f,
+            juce::AudioParameterFloatAttributes().withLabel("dB")));
+        
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(
+            getEQBandParameterID(band, "Range"), name + " Range",
+            juce::NormalisableRange<float>(-24.0f, 0.0f, 0.1f), 0.0f,
+            juce::AudioParameterFloatAttributes().withLabel("dB")));
+    }
+    
     // Master Parameters
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "inputGain", "Input Gain", 
@@ -115,6 +266,11 @@ juce::AudioProcessorValueTreeState::ParameterLayout VocalAIProPlugin::createPara
     params.push_back(std::make_unique<juce::AudioParameterBool>(
         "bypass", "Bypass", false));
     
+    // Order matches NonFiniteGuard::Policy
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "inputGuardPolicy", "Input Guard",
+        juce::StringArray { "Sanitize", "Mute with Fade" }, 1));
+    
     return { params.begin(), params.end() };
 }
 
@@ -153,7 +309,7 @@ bool VocalAIProPlugin::isMidiEffect() const
 
 double VocalAIProPlugin::getTailLengthSeconds() const
 {
-    return 0.0;
+    return vocalEffects ? vocalEffects->getTailLengthSeconds() : 0.0;
 }
 
 int VocalAIProPlugin::getNumPrograms()
@@ -230,28 +386,19 @@ void VocalAIProPlugin::prepareToPlay (double sampleRate, int samplesPerBlock)
         outputGain.prepare(spec);
         dryWetMixer.prepare(spec);
         
-        // Initialize spectrum analysis
-        fft = std::make_unique<juce::dsp::FFT>(10); // 1024 point FFT
-        fftData.resize(2048, 0.0f);
-        window.resize(1024, 0.0f);
-        spectrumMagnitudes.resize(512, 0.0f);
-        
-        // Create Hann window
-        for (int i = 0; i < 1024; ++i)
-        {
-            window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / 1023.0f));
-        }
-        
         // Initialize parameter smoothers
         inputGainSmoother.reset(sampleRate, 0.05); // 50ms smoothing
         outputGainSmoother.reset(sampleRate, 0.05);
-        reverbAmountSmoother.reset(sampleRate, 0.1); // 100ms smoothing
-        delayTimeSmoother.reset(sampleRate, 0.2); // 200ms smoothing
+        
+        profiler.prepare(sampleRate);
+        inputGuard.prepare(sampleRate);
         
         // Prepare AI components with error checking
         if (aiPitchTuner)
         {
             aiPitchTuner->prepare(sampleRate, samplesPerBlock, getTotalNumInputChannels());
+            aiPitchTuner->setPitchShiftEngine(static_cast<AIPitchTuner::PitchShiftEngine>(
+                juce::roundToInt(pitchEngineParam->load())));
         }
         else
         {
@@ -261,6 +408,14 @@ void VocalAIProPlugin::prepareToPlay (double sampleRate, int samplesPerBlock)
         if (vocalEffects)
         {
             vocalEffects->prepare(sampleRate, samplesPerBlock, getTotalNumInputChannels());
+            vocalEffects->setProfiler(&profiler);
+            
+            // MIDI reaches the harmony with the audio the tuner delayed
+            if (aiPitchTuner)
+            {
+                harmonyMidiDelay = aiPitchTuner->getLatencySamples();
+                vocalEffects->setHarmonyMidiDelay(harmonyMidiDelay);
+            }
         }
         else
         {
@@ -269,6 +424,10 @@ void VocalAIProPlugin::prepareToPlay (double sampleRate, int samplesPerBlock)
         
         isInitialized = true;
         updateParameters();
+        
+        // Not on the audio thread here, so the host hears about it right away
+        updateLatency();
+        setLatencySamples(requiredLatency.load());
     }
     catch (const std::exception& e)
     {
@@ -306,7 +465,8 @@ bool VocalAIProPlugin::isBusesLayoutSupported (const BusesLayout& layouts) const
 
 void VocalAIProPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
+    // Debug builds assert on any heap use below this point
+    AudioThreadGuard::ScopedRealtimeSection realtimeSection;
 
     // Enhanced error handling and validation
     try
@@ -317,21 +477,15 @@ void VocalAIProPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::Mid
             return;
         }
         
-        // Check for NaN or infinity in buffer
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-        {
-            const float* channelData = buffer.getReadPointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                if (std::isnan(channelData[sample]) || std::isinf(channelData[sample]))
-                {
-                    buffer.clear();
-                    return;
-                }
-            }
-        }
+        // Repair NaN/Inf input before it reaches any filter state; muting
+        // here lets effect tails decay instead of cutting the block
+        inputGuard.setPolicy(static_cast<NonFiniteGuard::Policy>(juce::roundToInt(inputGuardPolicyParam->load())));
+        inputGuard.process(buffer);
 
         juce::ScopedNoDenormals noDenormals;
+        VOCALAI_PROFILE_BLOCK(profiler, buffer.getNumSamples());
+        VOCALAI_PROFILE_STAGE(&profiler, total);
+        
         auto totalNumInputChannels  = getTotalNumInputChannels();
         auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -342,6 +496,13 @@ void VocalAIProPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::Mid
         // Bypass check - must be first!
         if (bypassParam->load() > 0.5f)
         {
+            // Keep the reported latency while bypassed
+            if (aiPitchTuner)
+                aiPitchTuner->processBypassed(buffer);
+            
+            if (vocalEffects)
+                vocalEffects->processBypassed(buffer);
+            
             return;
         }
         
@@ -356,6 +517,19 @@ void VocalAIProPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::Mid
             return;
         }
         
+        // The pitch engine and the compressor look-ahead both move the latency
+        // (only recorded here; timerCallback reports it to the host)
+        updateLatency();
+        
+        // Host tempo for the synced delay, read once per block
+        if (vocalEffects)
+        {
+            if (auto* playHead = getPlayHead())
+                if (auto position = playHead->getPosition())
+                    if (auto bpm = position->getBpm())
+                        vocalEffects->setHostTempo(*bpm);
+        }
+        
         // Apply input gain with validation
         auto currentInputGain = inputGainSmoother.getNextValue();
         if (std::isnan(currentInputGain) || std::isinf(currentInputGain))
@@ -369,10 +543,12 @@ void VocalAIProPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::Mid
         }
         
         // AI Pitch Tuning with error handling
-        if (aiPitchTuner && pitchCorrectionEnabledParam->load() > 0.5f)
+        // (always runs: when disabled it only applies the fixed latency)
+        if (aiPitchTuner)
         {
             try
             {
+                VOCALAI_PROFILE_STAGE(&profiler, pitchTuner);
                 aiPitchTuner->processBlock(buffer, midiMessages);
             }
             catch (const std::exception& e)
@@ -386,14 +562,28 @@ void VocalAIProPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::Mid
         {
             try
             {
+                // Harmony voices reuse the tuner's per-channel pitch analysis
+                if (aiPitchTuner)
+                {
+                    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                        vocalEffects->setHarmonySourcePitch(channel, aiPitchTuner->getOutputPitch(channel));
+                }
+                
                 vocalEffects->processBlock(buffer, midiMessages);
                 
-                // Apply additional vocal enhancement
+                // Dynamic EQ per channel, then the compressor
                 for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
                 {
                     float* channelData = buffer.getWritePointer(channel);
-                    vocalEffects->applyDynamicEQ(channelData, buffer.getNumSamples(), currentSampleRate);
-                    vocalEffects->applyVocalEnhancement(channelData, buffer.getNumSamples(), currentSampleRate);
+                    
+                    VOCALAI_PROFILE_STAGE(&profiler, dynamicEQ);
+                    vocalEffects->applyDynamicEQ(channel, channelData, buffer.getNumSamples());
+                }
+                
+                {
+                    // Stereo-linked, so both channels go through together
+                    VOCALAI_PROFILE_STAGE(&profiler, compressor);
+                    vocalEffects->applyCompression(buffer);
                 }
             }
             catch (const std::exception& e)
@@ -414,14 +604,10 @@ void VocalAIProPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::Mid
             buffer.applyGain(juce::jlimit(0.0f, 10.0f, currentOutputGain));
         }
         
-        // Update spectrum analysis for visual feedback
-        try
+        // Hand the output to the spectrum display (lock-free; no FFT here)
         {
-            updateSpectrum(buffer);
-        }
-        catch (const std::exception& e)
-        {
-            DBG("Error in spectrum analysis: " << e.what());
+            VOCALAI_PROFILE_STAGE(&profiler, spectrum);
+            spectrumAnalysis.pushSamples(buffer.getReadPointer(0), buffer.getNumSamples());
         }
     }
     catch (const std::exception& e)
@@ -458,6 +644,9 @@ void VocalAIProPlugin::getStateInformation (juce::MemoryBlock& destData)
     }
     state.addChild(presetNamesTree, -1, nullptr);
     
+    // The impulse response is referenced by path, not embedded
+    state.setProperty("reverbImpulseResponse", reverbImpulseResponseFile.getFullPathName(), nullptr);
+    
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary (*xml, destData);
 }
@@ -492,12 +681,53 @@ void VocalAIProPlugin::setStateInformation (const void* data, int sizeInBytes)
                 }
             }
             
+            // Reload the impulse response in the background
+            const juce::String impulseResponsePath = state.getProperty("reverbImpulseResponse", juce::String());
+            if (impulseResponsePath.isNotEmpty() && juce::File(impulseResponsePath).existsAsFile())
+                loadReverbImpulseResponse(juce::File(impulseResponsePath));
+            
             parameters.replaceState (state);
         }
     }
 }
 
 //==============================================================================
+void VocalAIProPlugin::loadReverbImpulseResponse(const juce::File& file)
+{
+    if (! vocalEffects || ! file.existsAsFile())
+        return;
+    
+    reverbImpulseResponseFile = file;
+    vocalEffects->loadReverbImpulseResponse(file);
+}
+
+//==============================================================================
+void VocalAIProPlugin::updateLatency()
+{
+    const int tunerLatency = aiPitchTuner ? aiPitchTuner->getLatencySamples() : 0;
+    const int effectsLatency = vocalEffects ? vocalEffects->getLatencySamples() : 0;
+    
+    // The streaming vocoder delays the signal by a fixed amount (PSOLA by none)
+    requiredLatency.store(tunerLatency + effectsLatency);
+    
+    // MIDI reaches the harmony with the audio the tuner delayed; the
+    // compressor runs after the harmony, so its look-ahead is not included.
+    // Only pushed on a change, since it drops the notes still in flight
+    if (vocalEffects && tunerLatency != harmonyMidiDelay)
+    {
+        harmonyMidiDelay = tunerLatency;
+        vocalEffects->setHarmonyMidiDelay(harmonyMidiDelay);
+    }
+}
+
+void VocalAIProPlugin::timerCallback()
+{
+    const int latency = requiredLatency.load();
+    
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
 void VocalAIProPlugin::updateParameters()
 {
     if (!isInitialized) return;
@@ -507,23 +737,53 @@ void VocalAIProPlugin::updateParameters()
     float outputGainDb = juce::jlimit(-24.0f, 12.0f, outputGainParam->load());
     inputGainSmoother.setTargetValue(juce::Decibels::decibelsToGain(inputGainDb));
     outputGainSmoother.setTargetValue(juce::Decibels::decibelsToGain(outputGainDb));
-    reverbAmountSmoother.setTargetValue(reverbAmountParam->load() / 100.0f);
-    delayTimeSmoother.setTargetValue(delayTimeParam->load());
     
     // Update AI components
     if (aiPitchTuner)
     {
         aiPitchTuner->setPitchCorrection(pitchCorrectionParam->load() / 100.0f);
         aiPitchTuner->setPitchSpeed(pitchSpeedParam->load() / 100.0f);
+        aiPitchTuner->setDetectionAlgorithm(static_cast<AIPitchTuner::PitchDetectionAlgorithm>(
+            juce::roundToInt(pitchDetectorParam->load())));
+        aiPitchTuner->setPitchShiftEngine(static_cast<AIPitchTuner::PitchShiftEngine>(
+            juce::roundToInt(pitchEngineParam->load())));
+        aiPitchTuner->setFormantPreservation(formantPreserveParam->load() > 0.5f);
+        aiPitchTuner->setFormantShift(formantShiftParam->load());
+        aiPitchTuner->setLinkedStereo(pitchStereoLinkParam->load() > 0.5f);
+        aiPitchTuner->setCorrectionEnabled(pitchCorrectionEnabledParam->load() > 0.5f);
+        aiPitchTuner->setMidiTargetMode(midiModeParam->load() > 0.5f);
     }
     
     if (vocalEffects)
     {
-        vocalEffects->setReverbAmount(reverbAmountSmoother.getNextValue());
-        vocalEffects->setDelayTime(delayTimeSmoother.getNextValue());
+        vocalEffects->setReverbAmount(reverbAmountParam->load() / 100.0f); // Ramped per sample by the dry/wet mixer
+        vocalEffects->setReverbMode(juce::roundToInt(reverbModeParam->load()));
+        vocalEffects->setDelayTime(delayTimeParam->load()); // Glided per sample by the delay network
         vocalEffects->setDelayFeedback(delayFeedbackParam->load() / 100.0f);
+        vocalEffects->setDelaySync(delaySyncParam->load() > 0.5f);
+        vocalEffects->setDelayDivision(juce::roundToInt(delayDivisionParam->load()));
+        vocalEffects->setDelayMode(juce::roundToInt(delayModeParam->load()));
         vocalEffects->setHarmonyAmount(harmonyAmountParam->load() / 100.0f);
         vocalEffects->setHarmonyVoices(static_cast<int>(harmonyVoicesParam->load()));
+        vocalEffects->setCompressorThreshold(compressorThresholdParam->load());
+        vocalEffects->setCompressorRatio(compressorRatioParam->load());
+        vocalEffects->setCompressorKnee(compressorKneeParam->load());
+        vocalEffects->setCompressorMakeup(compressorMakeupParam->load());
+        vocalEffects->setCompressorLookAhead(compressorLookAheadParam->load());
+        vocalEffects->setCompressorStereoLink(compressorStereoLinkParam->load() > 0.5f);
+        vocalEffects->setHarmonyMidiMode(midiModeParam->load() > 0.5f);
+        
+        // Harmony needs the tuner's pitch even when correction is switched off
+        if (aiPitchTuner)
+            aiPitchTuner->setAnalysisEnabled(vocalEffects->needsHarmonySourcePitch());
+        
+        // Coefficients only recompute for the bands that moved
+        for (size_t band = 0; band < static_cast<size_t>(DynamicEQ::numBands); ++band)
+            vocalEffects->setDynamicEQBand(static_cast<int>(band),
+                                           eqBandFrequencyParams[band]->load(),
+                                           eqBandGainParams[band]->load(),
+                                           eqBandThresholdParams[band]->load(),
+                                           eqBandRangeParams[band]->load());
     }
 }
 
@@ -536,6 +796,11 @@ void VocalAIProPlugin::parameterChanged(const juce::String& parameterID, float n
     checkForCustomPreset();
 }
 
+juce::String VocalAIProPlugin::getEQBandParameterID(int band, const char* suffix)
+{
+    return "eqBand" + juce::String(band + 1) + suffix;
+}
+
 bool VocalAIProPlugin::validateParameter(const juce::String& parameterID, float value)
 {
     // Check for NaN or infinity
@@ -709,38 +974,6 @@ void VocalAIProPlugin::checkForCustomPreset()
     isCustomPreset = !matchesPreset;
 }
 
-//==============================================================================
-// Spectrum Analysis Implementation
-void VocalAIProPlugin::updateSpectrum(const juce::AudioBuffer<float>& buffer)
-{
-    if (!isInitialized || buffer.getNumSamples() < 1024) return;
-    
-    // Get left channel data
-    const float* channelData = buffer.getReadPointer(0);
-    
-    // Apply window and prepare for FFT
-    for (int i = 0; i < 1024; ++i)
-    {
-        fftData[i] = channelData[i] * window[i];
-        fftData[i + 1024] = 0.0f; // Zero padding
-    }
-    
-    // Perform FFT
-    fft->performFrequencyOnlyForwardTransform(fftData.data());
-    
-    // Calculate magnitudes and convert to dB
-    for (int i = 0; i < 512; ++i)
-    {
-        float real = fftData[i * 2];
-        float imag = fftData[i * 2 + 1];
-        float magnitude = std::sqrt(real * real + imag * imag);
-        
-        // Convert to dB and normalize
-        float db = juce::Decibels::gainToDecibels(magnitude + 1e-10f);
-        spectrumMagnitudes[i] = juce::jlimit(0.0f, 1.0f, (db + 60.0f) / 60.0f);
-    }
-}
-
 //==============================================================================
 // This creates new instances of the plugin
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "StageProfiler.h"
+#include "NonFiniteGuard.h"
+#include "SpectrumAnalysis.h"
+#include "DynamicEQ.h"
 #include <memory>
 
 // Forward declarations
@@ -16,7 +20,8 @@ class VocalEffects;
     - Real-time Processing
     - Preset System
 */
-class VocalAIProPlugin : public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener
+class VocalAIProPlugin : public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener,
+                         private juce::Timer
 {
 public:
     //==============================================================================
@@ -94,26 +99,54 @@ public:
     std::atomic<float>* pitchCorrectionParam;
     std::atomic<float>* pitchSpeedParam;
     std::atomic<float>* pitchCorrectionEnabledParam;
+    std::atomic<float>* pitchDetectorParam;
+    std::atomic<float>* pitchEngineParam;         // Phase vocoder, or zero-latency PSOLA for tracking
+    std::atomic<float>* formantPreserveParam;
+    std::atomic<float>* formantShiftParam;        // Semitones, phase vocoder engine
+    std::atomic<float>* pitchStereoLinkParam;
+    std::atomic<float>* midiModeParam;            // Held notes drive the tuner target and harmony voices
     
     // Vocal Effects Parameters
     std::atomic<float>* reverbAmountParam;
+    std::atomic<float>* reverbModeParam;          // Algorithmic (FDN) or convolution
     std::atomic<float>* delayTimeParam;
     std::atomic<float>* delayFeedbackParam;
+    std::atomic<float>* delaySyncParam;           // Delay follows the host tempo
+    std::atomic<float>* delayDivisionParam;
+    std::atomic<float>* delayModeParam;           // Normal, ping-pong or wide stereo repeats
     std::atomic<float>* harmonyAmountParam;
     std::atomic<float>* harmonyVoicesParam;
+    std::atomic<float>* compressorThresholdParam;
+    std::atomic<float>* compressorRatioParam;
+    std::atomic<float>* compressorKneeParam;
+    std::atomic<float>* compressorMakeupParam;
+    std::atomic<float>* compressorLookAheadParam;  // Adds to the reported latency
+    std::atomic<float>* compressorStereoLinkParam;
+    
+    // Dynamic EQ, one entry per band ("eqBand1Frequency" ...)
+    std::array<std::atomic<float>*, DynamicEQ::numBands> eqBandFrequencyParams {};
+    std::array<std::atomic<float>*, DynamicEQ::numBands> eqBandGainParams {};
+    std::array<std::atomic<float>*, DynamicEQ::numBands> eqBandThresholdParams {};
+    std::array<std::atomic<float>*, DynamicEQ::numBands> eqBandRangeParams {};
     
     // Master Parameters
     std::atomic<float>* inputGainParam;
     std::atomic<float>* outputGainParam;
     std::atomic<float>* bypassParam;
+    std::atomic<float>* inputGuardPolicyParam;    // What the NaN/Inf guard does with bad input
     
     // Getter functions for editor access
     AIPitchTuner* getAIPitchTuner() const { return aiPitchTuner.get(); }
     VocalEffects* getVocalEffects() const { return vocalEffects.get(); }
+    StageProfiler& getProfiler() { return profiler; }
+    NonFiniteGuard& getInputGuard() { return inputGuard; }
     
-    // Spectrum Analysis
-    void updateSpectrum(const juce::AudioBuffer<float>& buffer);
-    const std::vector<float>& getSpectrumMagnitudes() const { return spectrumMagnitudes; }
+    // Spectrum Analysis (editor drains it and runs the FFT on its own thread)
+    SpectrumAnalysis& getSpectrumAnalysis() { return spectrumAnalysis; }
+    
+    // Convolution reverb IR (message thread; loads in the background)
+    void loadReverbImpulseResponse(const juce::File& file);
+    const juce::File& getReverbImpulseResponseFile() const { return reverbImpulseResponseFile; }
 
 private:
     //==============================================================================
@@ -128,21 +161,27 @@ private:
     juce::dsp::Gain<float> outputGain;
     juce::dsp::DryWetMixer<float> dryWetMixer;
     
+    // NaN/Inf repair on the input (sanitize, or mute with a short fade)
+    NonFiniteGuard inputGuard;
+    
+    // Per-stage processBlock timing (compiled out unless VOCALAI_ENABLE_PROFILING)
+    StageProfiler profiler;
+    
     // Spectrum Analysis
-    std::unique_ptr<juce::dsp::FFT> fft;
-    std::vector<float> fftData;
-    std::vector<float> window;
-    std::vector<float> spectrumMagnitudes;
+    SpectrumAnalysis spectrumAnalysis;
+    
+    // Convolution reverb impulse response, saved with the session
+    juce::File reverbImpulseResponseFile;
     
     // Parameter Smoothing
     juce::LinearSmoothedValue<float> inputGainSmoother;
     juce::LinearSmoothedValue<float> outputGainSmoother;
-    juce::LinearSmoothedValue<float> reverbAmountSmoother;
-    juce::LinearSmoothedValue<float> delayTimeSmoother;
     
     // Processing State
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
+    int harmonyMidiDelay = 0;           // Last delay pushed to the harmony's MIDI queue
+    std::atomic<int> requiredLatency { 0 };  // Set by the audio thread, reported from the timer
     bool isInitialized = false;
     
     //==============================================================================
@@ -153,6 +192,15 @@ private:
     // Parameter Update Handling
     void updateParameters();
     
+    // Works out tuner plus compressor latency; the host is told from the message thread
+    void updateLatency();
+    
+    // juce::Timer: reports a changed latency outside processBlock
+    void timerCallback() override;
+    
+    // Dynamic EQ parameter IDs: "eqBand" + (band + 1) + suffix
+    static juce::String getEQBandParameterID(int band, const char* suffix);
+    
     // Parameter Validation
     bool validateParameter(const juce::String& parameterID, float value);
     float sanitizeParameter(float value, float minVal, float maxVal);
@@ -0,0 +1,204 @@
+#include "VocalCompressor.h"
+
+namespace
+{
+    constexpr float levelFloor = 1.0e-6f;      // -120 dBFS, keeps log10() finite
+    constexpr int maxChunkSize = 512;
+
+    bool parametersDiffer(const VocalCompressor::Parameters& a, const VocalCompressor::Parameters& b) noexcept
+    {
+        return a.thresholdDb != b.thresholdDb || a.ratio != b.ratio || a.kneeDb != b.kneeDb
+            || a.attackMs != b.attackMs || a.releaseMs != b.releaseMs || a.makeupDb != b.makeupDb
+            || a.lookAheadMs != b.lookAheadMs || a.stereoLink != b.stereoLink;
+    }
+}
+
+//==============================================================================
+void VocalCompressor::prepare(double newSampleRate, int maxBlockSize, int numChannels)
+{
+    sampleRate = newSampleRate;
+    numPreparedChannels = juce::jmax(1, numChannels);
+
+    const int maxLookAhead = static_cast<int>(std::ceil(maxLookAheadMs * 0.001 * sampleRate));
+    ringSize = juce::nextPowerOfTwo(maxLookAhead + 1);
+    ringMask = ringSize - 1;
+    delayLines.assign(static_cast<size_t>(ringSize * numPreparedChannels), 0.0f);
+
+    chunkSize = juce::jlimit(1, maxChunkSize, maxBlockSize);
+    levelBuffer.assign(static_cast<size_t>(chunkSize), 0.0f);
+    gainBuffer.assign(static_cast<size_t>(chunkSize), 0.0f);
+    smoothedGainDb.assign(static_cast<size_t>(numPreparedChannels), 0.0f);
+
+    updateCoefficients();
+    reset();
+}
+
+void VocalCompressor::reset()
+{
+    std::fill(delayLines.begin(), delayLines.end(), 0.0f);
+    std::fill(smoothedGainDb.begin(), smoothedGainDb.end(), 0.0f);
+    writePosition = 0;
+}
+
+void VocalCompressor::setParameters(const Parameters& newParameters)
+{
+    Parameters clamped;
+    clamped.thresholdDb = juce::jlimit(-60.0f, 0.0f, newParameters.thresholdDb);
+    clamped.ratio = juce::jlimit(1.0f, 20.0f, newParameters.ratio);
+    clamped.kneeDb = juce::jlimit(0.0f, 24.0f, newParameters.kneeDb);
+    clamped.attackMs = juce::jlimit(0.1f, 200.0f, newParameters.attackMs);
+    clamped.releaseMs = juce::jlimit(5.0f, 2000.0f, newParameters.releaseMs);
+    clamped.makeupDb = juce::jlimit(-12.0f, 24.0f, newParameters.makeupDb);
+    clamped.lookAheadMs = juce::jlimit(0.0f, maxLookAheadMs, newParameters.lookAheadMs);
+    clamped.stereoLink = newParameters.stereoLink;
+
+    // Called every block; the exp() calls only run on an actual change
+    if (! parametersDiffer(clamped, parameters))
+        return;
+
+    parameters = clamped;
+    updateCoefficients();
+}
+
+void VocalCompressor::updateCoefficients()
+{
+    const float sr = static_cast<float>(sampleRate);
+
+    slope = 1.0f / parameters.ratio - 1.0f;
+    kneeWidth = parameters.kneeDb;
+
+    // One-pole smoothing: reaches 1 - 1/e of a step in the given time
+    attackCoeff = std::exp(-1.0f / (parameters.attackMs * 0.001f * sr));
+    releaseCoeff = std::exp(-1.0f / (parameters.releaseMs * 0.001f * sr));
+
+    lookAheadSamples = ringSize > 0 ? juce::jlimit(0, ringMask, juce::roundToInt(parameters.lookAheadMs * 0.001f * sr)) : 0;
+}
+
+//==============================================================================
+void VocalCompressor::process(float* const* channels, int numChannels, int numSamples) noexcept
+{
+    if (channels == nullptr || ringSize == 0 || numSamples <= 0)
+        return;
+
+    numChannels = juce::jmin(numChannels, numPreparedChannels);
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize)
+        processChunk(channels, numChannels, offset, juce::jmin(chunkSize, numSamples - offset));
+}
+
+void VocalCompressor::processBypassed(float* const* channels, int numChannels, int numSamples) noexcept
+{
+    if (channels == nullptr || ringSize == 0 || numSamples <= 0)
+        return;
+
+    numChannels = juce::jmin(numChannels, numPreparedChannels);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* samples = channels[channel];
+        float* ring = delayLines.data() + channel * ringSize;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const int position = writePosition + i;
+            ring[position & ringMask] = samples[i];
+            samples[i] = ring[(position - lookAheadSamples) & ringMask];
+        }
+    }
+
+    writePosition = (writePosition + numSamples) & ringMask;
+}
+
+void VocalCompressor::processChunk(float* const* channels, int numChannels, int startSample, int numSamples) noexcept
+{
+    float* level = levelBuffer.data();
+
+    if (parameters.stereoLink || numChannels < 2)
+    {
+        // One detector on the louder channel drives every channel
+        juce::FloatVectorOperations::abs(level, channels[0] + startSample, numSamples);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+        {
+            const float* samples = channels[channel] + startSample;
+            for (int i = 0; i < numSamples; ++i)
+                level[i] = juce::jmax(level[i], std::abs(samples[i]));
+        }
+
+        computeGain(0, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            applyGain(channel, channels[channel] + startSample, numSamples);
+    }
+    else
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* samples = channels[channel] + startSample;
+            juce::FloatVectorOperations::abs(level, samples, numSamples);
+            computeGain(channel, numSamples);
+            applyGain(channel, samples, numSamples);
+        }
+    }
+
+    writePosition = (writePosition + numSamples) & ringMask;
+}
+
+void VocalCompressor::computeGain(int detectorIndex, int numSamples) noexcept
+{
+    float* level = levelBuffer.data();
+    float* gain = gainBuffer.data();
+
+    // Peak level in dB
+    for (int i = 0; i < numSamples; ++i)
+        level[i] = 20.0f * std::log10(juce::jmax(level[i], levelFloor));
+
+    // Static curve without branches: the clamped term is the quadratic
+    // knee, the jmax term the straight line above it
+    const float threshold = parameters.thresholdDb;
+    const float halfKnee = 0.5f * kneeWidth;
+    const float inverseTwoKnee = 0.5f / juce::jmax(kneeWidth, 1.0e-6f);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float over = level[i] - threshold;
+        const float inKnee = juce::jlimit(0.0f, kneeWidth, over + halfKnee);
+        gain[i] = slope * (inKnee * inKnee * inverseTwoKnee + juce::jmax(over - halfKnee, 0.0f));
+    }
+
+    // Ballistics on the gain reduction: attack while it deepens, release
+    // while it recovers (a select, not a branch)
+    float state = smoothedGainDb[static_cast<size_t>(detectorIndex)];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float target = gain[i];
+        const float coeff = target < state ? attackCoeff : releaseCoeff;
+        state = target + coeff * (state - target);
+        gain[i] = state;
+    }
+
+    smoothedGainDb[static_cast<size_t>(detectorIndex)] = state;
+
+    // dB to linear, makeup folded in
+    const float decibelsToNepers = 0.05f * std::log(10.0f);
+    const float makeup = parameters.makeupDb;
+
+    for (int i = 0; i < numSamples; ++i)
+        gain[i] = std::exp((gain[i] + makeup) * decibelsToNepers);
+}
+
+void VocalCompressor::applyGain(int channelIndex, float* samples, int numSamples) noexcept
+{
+    const float* gain = gainBuffer.data();
+    float* ring = delayLines.data() + channelIndex * ringSize;
+
+    // The gain leads the delayed audio by the look-ahead. The ring is
+    // written even without look-ahead so enabling it never plays stale audio.
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int position = writePosition + i;
+        ring[position & ringMask] = samples[i];
+        samples[i] = ring[(position - lookAheadSamples) & ringMask] * gain[i];
+    }
+}
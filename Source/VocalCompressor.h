@@ -0,0 +1,86 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Vocal Compressor
+
+    Feed-forward compressor with a log-domain detector. Each chunk runs as
+    separate passes over flat arrays: peak level in dB, the static gain
+    curve (threshold, ratio, soft knee - branch-free, so it vectorises),
+    attack/release smoothing of the gain reduction, then the gain applied
+    to the audio. With look-ahead the audio is delayed so the gain lands
+    before the transient; that delay is the latency to report.
+
+    Linked stereo drives both channels from the louder one, keeping the
+    image still; unlinked, each channel has its own detector.
+*/
+class VocalCompressor
+{
+public:
+    //==============================================================================
+    static constexpr float maxLookAheadMs = 10.0f;
+
+    struct Parameters
+    {
+        float thresholdDb = -10.0f;     // -60..0
+        float ratio = 3.0f;             // 1..20
+        float kneeDb = 6.0f;            // 0..24, total width around the threshold
+        float attackMs = 5.0f;          // 0.1..200
+        float releaseMs = 120.0f;       // 5..2000
+        float makeupDb = 0.0f;          // -12..24
+        float lookAheadMs = 0.0f;       // 0..maxLookAheadMs
+        bool stereoLink = true;
+    };
+
+    // Allocates the look-ahead rings and chunk scratch. Not real-time safe.
+    void prepare(double newSampleRate, int maxBlockSize, int numChannels);
+    void reset();
+
+    // Coefficients are recomputed here, only when something changed
+    void setParameters(const Parameters& newParameters);
+    const Parameters& getParameters() const noexcept { return parameters; }
+
+    // Look-ahead delay of the processed audio
+    int getLatencySamples() const noexcept { return lookAheadSamples; }
+
+    //==============================================================================
+    void process(float* const* channels, int numChannels, int numSamples) noexcept;
+    
+    // Look-ahead delay at unity gain, so a bypassed chain keeps its latency
+    void processBypassed(float* const* channels, int numChannels, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    void processChunk(float* const* channels, int numChannels, int startSample, int numSamples) noexcept;
+    void computeGain(int detectorIndex, int numSamples) noexcept;
+    void applyGain(int channelIndex, float* samples, int numSamples) noexcept;
+    void updateCoefficients();
+
+    double sampleRate = 44100.0;
+    Parameters parameters;
+
+    // Derived once per parameter change
+    float slope = 0.0f;                 // 1 / ratio - 1
+    float kneeWidth = 0.0f;
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+    int lookAheadSamples = 0;
+
+    // Per-channel look-ahead rings, channel c at delayLines[c * ringSize]
+    std::vector<float> delayLines;
+    int ringSize = 0;
+    int ringMask = 0;
+    int writePosition = 0;
+    int numPreparedChannels = 0;
+
+    // Smoothed gain reduction per detector (one when linked)
+    std::vector<float> smoothedGainDb;
+
+    // Chunk scratch: detector level, then gain in dB, then linear gain
+    std::vector<float> levelBuffer;
+    std::vector<float> gainBuffer;
+    int chunkSize = 0;
+};
@@ -3,13 +3,6 @@
 //==============================================================================
 VocalEffects::VocalEffects()
 {
-    // Initialize reverb parameters
-    reverbParams.roomSize = 0.5f;
-    reverbParams.damping = 0.5f;
-    reverbParams.wetLevel = 0.3f;
-    reverbParams.dryLevel = 0.4f;
-    reverbParams.width = 1.0f;
-    reverbParams.freezeMode = 0.0f;
 }
 
 VocalEffects::~VocalEffects()
@@ -29,25 +22,39 @@ void VocalEffects::prepare(double newSampleRate, int newBlockSize, int newNumCha
     spec.maximumBlockSize = static_cast<juce::uint32>(blockSize);
     spec.numChannels = static_cast<juce::uint32>(numChannels);
     
-    reverb.prepare(spec);
+    reverb.prepare(sampleRate);
+    convolutionReverb.prepare(spec);
+    
+    // Constant-power blend; dry is delayed by whatever latency the wet path reports
     reverbMixer.prepare(spec);
-    reverbMixer.setWetMixProportion(0.0f);
+    reverbMixer.setMixingRule(juce::dsp::DryWetMixingRule::sin3dB);
+    reverbMixer.setWetLatency(static_cast<float>(convolutionReverb.getLatency()));
+    reverbMixer.setWetMixProportion(reverbAmount);
+    reverbMixRampSamples = static_cast<int>(std::ceil(reverbMixRampSeconds * sampleRate));
+    reverbMixRampRemaining = 0;
     
-    // Prepare delay line
-    int delayBufferSize = static_cast<int>(sampleRate * 2.0); // 2 seconds max delay
-    delayLine.prepare(delayBufferSize);
+    // Prepare delay network, doubler and per-channel filters
+    channelStates.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
     
-    // Prepare harmony generator
-    int harmonyBufferSize = static_cast<int>(sampleRate * 0.1); // 100ms buffer
-    harmonyGenerator.prepare(8, harmonyBufferSize);
+    // Sized once for the longest of the free time (2 s) and the slowest synced division,
+    // so tempo changes never reallocate
+    const double longestSyncedDelay = getDivisionBeats(divisionHalf) * 60.0 / minSyncTempo;
+    int delayBufferSize = static_cast<int>(std::ceil(sampleRate * juce::jmax(2.0, longestSyncedDelay))) + 1;
+    int doublerBufferSize = static_cast<int>(sampleRate * 0.16); // 1.5x the 100 ms maximum plus drift
     
-    // Prepare vocal doubler
-    int doublerBufferSize = static_cast<int>(sampleRate * 0.1); // 100ms buffer
+    delayNetwork.prepare(numChannels, delayBufferSize, sampleRate);
     vocalDoubler.prepare(doublerBufferSize);
     
-    // Prepare formant shifter
-    int formantBufferSize = static_cast<int>(sampleRate * 0.1); // 100ms buffer
-    formantShifter.prepare(formantBufferSize);
+    for (auto& state : channelStates)
+        state.resetFilters();
+    
+    // Prepare harmony generator
+    harmonyGenerator.prepare(numChannels, sampleRate);
+    
+    compressor.prepare(sampleRate, blockSize, numChannels);
+    updateCompressorParameters();
+    
+    dynamicEQ.prepare(sampleRate);
     
     isPrepared = true;
 }
@@ -61,74 +68,95 @@ void VocalEffects::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuff
         return;
     }
     
-    juce::ignoreUnused(midiMessages);
-    
     const int numSamples = buffer.getNumSamples();
-    const int numChannelsToProcess = juce::jmin(numChannels, buffer.getNumChannels());
+    const int numChannelsToProcess = juce::jmin(numChannels, buffer.getNumChannels(), static_cast<int>(channelStates.size()));
     
     // Additional safety check
     if (numSamples <= 0 || numChannelsToProcess <= 0) {
         return;
     }
     
+    // Apply vocal doubling first (for natural sound); the taps pan across both channels
+    if (doublingAmount > 0.0f)
+    {
+        VOCALAI_PROFILE_STAGE(profiler, doubler);
+        vocalDoubler.process(buffer.getWritePointer(0), numChannelsToProcess > 1 ? buffer.getWritePointer(1) : nullptr,
+                             numSamples, doublingTaps, doublingAmount, doublingDelay, doublingDetune, sampleRate);
+    }
+    
+    // Notes due in this block, shared by every channel's harmony pass
+    harmonyGenerator.beginMidiBlock(midiMessages, numSamples);
+    
     // Process each channel
     for (int channel = 0; channel < numChannelsToProcess; ++channel)
     {
         float* channelData = buffer.getWritePointer(channel);
         
-            // Apply vocal doubling first (for natural sound)
-    if (doublingAmount > 0.0f)
-    {
-        // Enhanced vocal doubling with formant preservation
-        vocalDoubler.process(channelData, numSamples, doublingAmount, doublingDelay, doublingDetune, sampleRate);
-        
-        // Apply subtle pitch variation for more natural sound
-        applyNaturalPitchVariation(channelData, numSamples, doublingAmount);
-    }
-        
         // Apply harmony generation
-        if (harmonyAmount > 0.0f && harmonyVoices > 1)
+        if (harmonyMidiMode)
         {
-            harmonyGenerator.process(channelData, numSamples, harmonyVoices, harmonyAmount, harmonyInterval, harmonyDetune);
+            VOCALAI_PROFILE_STAGE(profiler, harmony);
+            harmonyGenerator.processMidi(channel, channelData, numSamples, harmonyAmount);
         }
-        
-        // Apply formant shifting
-        if (formantAmount > 0.0f)
-        {
-            formantShifter.process(channelData, numSamples, formantShift, formantAmount);
-        }
-        
-        // Apply delay
-        if (delayMix > 0.0f)
+        else if (harmonyAmount > 0.0f && harmonyVoices > 1)
         {
-            delayLine.process(channelData, numSamples, delayTime, delayFeedback, delayMix, delayFilter, sampleRate);
+            VOCALAI_PROFILE_STAGE(profiler, harmony);
+            harmonyGenerator.process(channel, channelData, numSamples, harmonyVoices, harmonyAmount, harmonyInterval, harmonyDetune);
         }
     }
     
-    // Enhanced Reverb processing with improved quality
+    harmonyGenerator.endMidiBlock();
+    
+    // Apply delay (both channels together, one frame at a time)
+    if (delayMix > 0.0f)
+    {
+        VOCALAI_PROFILE_STAGE(profiler, delay);
+        delayNetwork.process(buffer.getArrayOfWritePointers(), numChannelsToProcess, numSamples, delayMode,
+                             getEffectiveDelayTime(), delayFeedback, delayMix, delayFilter, sampleRate);
+    }
+    
+    // Reverb runs fully wet in place; the mixer keeps the dry copy and blends
+    // with a constant-power law, ramping the amount per sample. It keeps
+    // running for one ramp after the amount reaches zero so the fade finishes.
     if (reverbAmount > 0.0f)
+        reverbMixRampRemaining = reverbMixRampSamples;
+    
+    if (reverbMixRampRemaining > 0)
     {
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
+        VOCALAI_PROFILE_STAGE(profiler, reverb);
+        
+        // Reverb parameters with validation
+        FDNReverb::Parameters reverbParameters;
+        reverbParameters.size = juce::jlimit(0.0f, 1.0f, reverbSize);
+        reverbParameters.damping = juce::jlimit(0.0f, 1.0f, reverbDamping);
+        reverbParameters.width = juce::jlimit(0.0f, 1.0f, reverbWidth);
+        reverbParameters.preDelayMs = reverbPreDelay;
+        reverb.setParameters(reverbParameters);
         
-        // Improved reverb parameters with validation
-        reverbParams.roomSize = juce::jlimit(0.0f, 1.0f, reverbSize);
-        reverbParams.damping = juce::jlimit(0.0f, 1.0f, reverbDamping);
-        reverbParams.wetLevel = juce::jlimit(0.0f, 1.0f, reverbAmount);
-        reverbParams.dryLevel = juce::jlimit(0.0f, 1.0f, 1.0f - reverbAmount);
-        reverbParams.width = juce::jlimit(0.0f, 1.0f, reverbWidth);
-        reverbParams.freezeMode = 0.0f;
+        reverbMixer.setWetMixProportion(reverbAmount);
         
-        // Apply smoothing to prevent artifacts
-        static juce::LinearSmoothedValue<float> reverbSmoother;
-        reverbSmoother.setTargetValue(reverbAmount);
-        float smoothedReverb = reverbSmoother.getNextValue();
+        const bool useConvolution = reverbMode == reverbModeConvolution && hasReverbImpulseResponse();
+        const auto fullBlock = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, static_cast<size_t>(numChannelsToProcess));
         
-        reverbParams.wetLevel = smoothedReverb;
-        reverbParams.dryLevel = 1.0f - smoothedReverb;
+        // The mixer holds at most the prepared block size of dry samples
+        for (int offset = 0; offset < numSamples; offset += blockSize)
+        {
+            const int chunkSize = juce::jmin(blockSize, numSamples - offset);
+            auto block = fullBlock.getSubBlock(static_cast<size_t>(offset), static_cast<size_t>(chunkSize));
+            
+            reverbMixer.pushDrySamples(block);
+            
+            if (useConvolution)
+                convolutionReverb.process(juce::dsp::ProcessContextReplacing<float>(block));
+            else
+                reverb.process(block.getChannelPointer(0), numChannelsToProcess > 1 ? block.getChannelPointer(1) : nullptr,
+                               chunkSize, 1.0f, 0.0f);
+            
+            reverbMixer.mixWetSamples(block);
+        }
         
-        reverb.setParameters(reverbParams);
-        reverb.process(context);
+        if (reverbAmount <= 0.0f)
+            reverbMixRampRemaining -= numSamples;
     }
 }
 
@@ -138,26 +166,22 @@ void VocalEffects::reset()
     
     // Reset reverb
     reverb.reset();
+    convolutionReverb.reset();
     reverbMixer.reset();
+    reverbMixRampRemaining = 0;
     
-    // Reset delay line
-    std::fill(delayLine.buffer.begin(), delayLine.buffer.end(), 0.0f);
-    delayLine.writePosition = 0;
+    delayNetwork.reset();
     
-    // Reset harmony generator
-    for (int i = 0; i < 8; ++i)
-    {
-        std::fill(harmonyGenerator.pitchShiftBuffers[i].begin(), harmonyGenerator.pitchShiftBuffers[i].end(), 0.0f);
-        std::fill(harmonyGenerator.delayBuffers[i].begin(), harmonyGenerator.delayBuffers[i].end(), 0.0f);
-        harmonyGenerator.writePositions[i] = 0;
-    }
+    vocalDoubler.reset();
+    
+    // Reset per-channel filters
+    for (auto& state : channelStates)
+        state.resetFilters();
     
-    // Reset vocal doubler
-    std::fill(vocalDoubler.delayBuffer.begin(), vocalDoubler.delayBuffer.end(), 0.0f);
-    vocalDoubler.writePosition = 0;
+    // Reset harmony generator
+    harmonyGenerator.reset();
     
-    // Reset formant shifter
-    std::fill(formantShifter.formantBuffer.begin(), formantShifter.formantBuffer.end(), 0.0f);
+    compressor.reset();
 }
 
 //==============================================================================
@@ -185,6 +209,32 @@ void VocalEffects::setReverbWidth(float width)
     reverbWidth = juce::jlimit(0.0f, 1.0f, width);
 }
 
+void VocalEffects::setReverbPreDelay(float preDelayMs)
+{
+    reverbPreDelay = juce::jlimit(0.0f, FDNReverb::maxPreDelayMs, preDelayMs);
+}
+
+void VocalEffects::setReverbMode(int mode)
+{
+    reverbMode = juce::jlimit(0, numReverbModes - 1, mode);
+}
+
+void VocalEffects::loadReverbImpulseResponse(const juce::File& file)
+{
+    // Full length, trimmed of leading/trailing silence, normalised; the
+    // convolution's loader thread resamples to the prepared rate
+    convolutionReverb.loadImpulseResponse(file,
+                                          juce::dsp::Convolution::Stereo::yes,
+                                          juce::dsp::Convolution::Trim::yes,
+                                          0,
+                                          juce::dsp::Convolution::Normalise::yes);
+}
+
+bool VocalEffects::hasReverbImpulseResponse() const
+{
+    return convolutionReverb.getCurrentIRSize() > 0;
+}
+
 //==============================================================================
 void VocalEffects::setDelayTime(float timeMs)
 {
@@ -206,6 +256,71 @@ void VocalEffects::setDelayFilter(float cutoff)
     delayFilter = juce::jlimit(20.0f, 20000.0f, cutoff);
 }
 
+void VocalEffects::setDelaySync(bool shouldSync)
+{
+    delaySync = shouldSync;
+}
+
+void VocalEffects::setDelayDivision(int division)
+{
+    delayDivision = juce::jlimit(0, numDelayDivisions - 1, division);
+}
+
+void VocalEffects::setDelayMode(int mode)
+{
+    delayMode = juce::jlimit(0, numDelayModes - 1, mode);
+}
+
+void VocalEffects::setHostTempo(double bpm)
+{
+    // Hosts without a transport report nothing or 0; keep the last good tempo
+    if (bpm > 0.0 && std::isfinite(bpm))
+        hostTempo = juce::jlimit(minSyncTempo, maxSyncTempo, bpm);
+}
+
+float VocalEffects::getDivisionBeats(int division)
+{
+    switch (division)
+    {
+        case divisionHalf:              return 2.0f;
+        case divisionQuarter:           return 1.0f;
+        case divisionQuarterDotted:     return 1.5f;
+        case divisionQuarterTriplet:    return 2.0f / 3.0f;
+        case divisionEighth:            return 0.5f;
+        case divisionEighthDotted:      return 0.75f;
+        case divisionEighthTriplet:     return 1.0f / 3.0f;
+        case divisionSixteenth:         return 0.25f;
+        default:                        return 1.0f;
+    }
+}
+
+double VocalEffects::getTailLengthSeconds() const
+{
+    // Reverb: the loaded IR, or the FDN's RT60 after its pre-delay
+    double tail = FDNReverb::getDecayTimeSeconds(reverbSize) + reverbPreDelay * 0.001;
+    
+    if (hasReverbImpulseResponse())
+        tail = juce::jmax(tail, static_cast<double>(convolutionReverb.getCurrentIRSize()) / sampleRate);
+    
+    // Delay: repeats until the feedback has taken them 60 dB down
+    double repeatMs = getEffectiveDelayTime();
+    if (delayMode == delayModeWide)
+        repeatMs += DelayNetwork::wideOffsetMs;
+    
+    const double repeats = delayFeedback > 0.0f ? -3.0 / std::log10(static_cast<double>(delayFeedback)) : 0.0;
+    
+    return juce::jmax(tail, repeatMs * 0.001 * (1.0 + repeats));
+}
+
+float VocalEffects::getEffectiveDelayTime() const
+{
+    if (! delaySync)
+        return delayTime;
+    
+    // Tempo changes glide through the delay line's per-sample smoother
+    return static_cast<float>(getDivisionBeats(delayDivision) * 60000.0 / hostTempo);
+}
+
 //==============================================================================
 void VocalEffects::setHarmonyAmount(float amount)
 {
@@ -217,6 +332,21 @@ void VocalEffects::setHarmonyVoices(int voices)
     harmonyVoices = juce::jlimit(1, 8, voices);
 }
 
+void VocalEffects::setHarmonyMidiMode(bool shouldUseMidi)
+{
+    harmonyMidiMode = shouldUseMidi;
+}
+
+void VocalEffects::setHarmonyMidiDelay(int delaySamples)
+{
+    harmonyGenerator.setMidiDelay(delaySamples);
+}
+
+void VocalEffects::setHarmonySourcePitch(int channel, float frequency)
+{
+    harmonyGenerator.setSourcePitch(channel, frequency);
+}
+
 void VocalEffects::setHarmonyInterval(int semitones)
 {
     harmonyInterval = juce::jlimit(-12, 12, semitones);
@@ -243,111 +373,101 @@ void VocalEffects::setDoublingDetune(float detune)
     doublingDetune = juce::jlimit(-50.0f, 50.0f, detune);
 }
 
+void VocalEffects::setDoublingTaps(int taps)
+{
+    doublingTaps = juce::jlimit(VocalDoubler::minTaps, VocalDoubler::maxTaps, taps);
+}
+
 //==============================================================================
-void VocalEffects::setFormantShift(float shift)
+void VocalEffects::setCompressorThreshold(float thresholdDb)
+{
+    compressorThreshold = juce::jlimit(-60.0f, 0.0f, thresholdDb);
+    updateCompressorParameters();
+}
+
+void VocalEffects::setCompressorRatio(float ratio)
+{
+    compressorRatio = juce::jlimit(1.0f, 20.0f, ratio);
+    updateCompressorParameters();
+}
+
+void VocalEffects::setCompressorKnee(float kneeDb)
+{
+    compressorKnee = juce::jlimit(0.0f, 24.0f, kneeDb);
+    updateCompressorParameters();
+}
+
+void VocalEffects::setCompressorMakeup(float makeupDb)
+{
+    compressorMakeup = juce::jlimit(-12.0f, 24.0f, makeupDb);
+    updateCompressorParameters();
+}
+
+void VocalEffects::setCompressorLookAhead(float lookAheadMs)
+{
+    compressorLookAhead = juce::jlimit(0.0f, VocalCompressor::maxLookAheadMs, lookAheadMs);
+    updateCompressorParameters();
+}
+
+void VocalEffects::setCompressorStereoLink(bool shouldLink)
 {
-    formantShift = juce::jlimit(-1.0f, 1.0f, shift);
+    compressorStereoLink = shouldLink;
+    updateCompressorParameters();
 }
 
-void VocalEffects::setFormantAmount(float amount)
+void VocalEffects::setDynamicEQBand(int band, float frequencyHz, float gainDb, float thresholdDb, float rangeDb)
 {
-    formantAmount = juce::jlimit(0.0f, 1.0f, amount);
+    DynamicEQ::BandParameters bandParameters;
+    bandParameters.frequency = frequencyHz;
+    bandParameters.gainDb = gainDb;
+    bandParameters.thresholdDb = thresholdDb;
+    bandParameters.rangeDb = rangeDb;
+    dynamicEQ.setBand(band, bandParameters);
+}
+
+void VocalEffects::updateCompressorParameters()
+{
+    // Attack and release keep the module defaults
+    auto compressorParameters = compressor.getParameters();
+    compressorParameters.thresholdDb = compressorThreshold;
+    compressorParameters.ratio = compressorRatio;
+    compressorParameters.kneeDb = compressorKnee;
+    compressorParameters.makeupDb = compressorMakeup;
+    compressorParameters.lookAheadMs = compressorLookAhead;
+    compressorParameters.stereoLink = compressorStereoLink;
+    compressor.setParameters(compressorParameters);
 }
 
 //==============================================================================
 // Advanced Audio Processing Implementation
-void VocalEffects::applyNaturalPitchVariation(float* samples, int numSamples, float amount)
+void VocalEffects::applyDynamicEQ(int channel, float* samples, int numSamples)
 {
-    if (amount < 0.01f) return;
+    auto* state = getChannelState(channel);
+    if (state == nullptr) return;
     
-    // Apply subtle pitch variation for more natural vocal doubling
-    static float phase = 0.0f;
-    const float frequency = 0.5f; // 0.5 Hz modulation
-    const float depth = 0.02f * amount; // 2% pitch variation max
-    
-    for (int i = 0; i < numSamples; ++i)
+    // Flat bands cost nothing once the last move has glided out; the filter
+    // state is cleared then so re-enabling starts clean
+    if (dynamicEQ.isNeutral() && dynamicEQ.hasSettled(state->dynamicEQ))
     {
-        float modulation = std::sin(phase) * depth;
-        float pitchRatio = 1.0f + modulation;
-        
-        // Simple pitch shifting
-        float sourceIndex = i / pitchRatio;
-        int sourceIndexInt = static_cast<int>(sourceIndex);
-        float fraction = sourceIndex - sourceIndexInt;
-        
-        if (sourceIndexInt >= 0 && sourceIndexInt < numSamples - 1)
-        {
-            samples[i] = samples[sourceIndexInt] * (1.0f - fraction) + 
-                        samples[sourceIndexInt + 1] * fraction;
-        }
-        
-        phase += 2.0f * juce::MathConstants<float>::pi * frequency / static_cast<float>(sampleRate);
-        if (phase > 2.0f * juce::MathConstants<float>::pi)
-            phase -= 2.0f * juce::MathConstants<float>::pi;
+        state->resetFilters();
+        return;
     }
+    
+    dynamicEQ.process(state->dynamicEQ, samples, numSamples);
 }
 
-void VocalEffects::applyDynamicEQ(float* samples, int numSamples, double sampleRate)
+void VocalEffects::applyCompression(juce::AudioBuffer<float>& buffer)
 {
-    // Simple dynamic EQ for vocal enhancement
-    static float lowShelfState = 0.0f;
-    static float highShelfState = 0.0f;
-    
-    const float lowCutoff = 80.0f;
-    const float highCutoff = 8000.0f;
+    if (!isPrepared) return;
     
-    for (int i = 0; i < numSamples; ++i)
-    {
-        float sample = samples[i];
-        
-        // Low shelf filter (boost bass)
-        float lowCoeff = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * lowCutoff / static_cast<float>(sampleRate));
-        lowShelfState += lowCoeff * (sample - lowShelfState);
-        sample = sample + lowShelfState * 0.1f; // 10% boost
-        
-        // High shelf filter (boost presence)
-        float highCoeff = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * highCutoff / static_cast<float>(sampleRate));
-        highShelfState += highCoeff * (sample - highShelfState);
-        sample = sample + highShelfState * 0.05f; // 5% boost
-        
-        samples[i] = sample;
-    }
+    const int numChannelsToProcess = juce::jmin(numChannels, buffer.getNumChannels());
+    compressor.process(buffer.getArrayOfWritePointers(), numChannelsToProcess, buffer.getNumSamples());
 }
 
-void VocalEffects::applyVocalEnhancement(float* samples, int numSamples, double sampleRate)
+void VocalEffects::processBypassed(juce::AudioBuffer<float>& buffer)
 {
-    // Apply subtle compression and enhancement
-    static float envelope = 0.0f;
-    const float attackTime = 0.001f; // 1ms attack
-    const float releaseTime = 0.1f;  // 100ms release
-    const float threshold = 0.3f;
-    const float ratio = 3.0f;
+    if (!isPrepared) return;
     
-    for (int i = 0; i < numSamples; ++i)
-    {
-        float input = samples[i];
-        float inputLevel = std::abs(input);
-        
-        // Envelope follower
-        if (inputLevel > envelope)
-        {
-            envelope += (inputLevel - envelope) * attackTime * static_cast<float>(sampleRate);
-        }
-        else
-        {
-            envelope += (inputLevel - envelope) * releaseTime * static_cast<float>(sampleRate);
-        }
-        
-        // Compression
-        if (envelope > threshold)
-        {
-            float gainReduction = 1.0f - (envelope - threshold) / envelope * (1.0f - 1.0f / ratio);
-            input *= gainReduction;
-        }
-        
-        // Apply makeup gain
-        input *= 1.2f; // 20% makeup gain
-        
-        samples[i] = input;
-    }
+    const int numChannelsToProcess = juce::jmin(numChannels, buffer.getNumChannels());
+    compressor.processBypassed(buffer.getArrayOfWritePointers(), numChannelsToProcess, buffer.getNumSamples());
 }
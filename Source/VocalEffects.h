@@ -1,17 +1,24 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "StageProfiler.h"
+#include "MidiVoicePool.h"
+#include "FractionalDelayLine.h"
+#include "FDNReverb.h"
+#include "VocalCompressor.h"
+#include "DynamicEQ.h"
+#include <array>
 
 //==============================================================================
 /**
     Vocal Effects Processing Module
     
     Features:
-    - Reverb with multiple algorithms
+    - Feedback delay network or convolution reverb
     - Delay with feedback and filtering
     - Harmony generation
     - Vocal doubling
-    - Formant shifting
+    - Look-ahead compressor
 */
 class VocalEffects
 {
@@ -23,6 +30,7 @@ public:
     //==============================================================================
     void prepare(double sampleRate, int blockSize, int numChannels);
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    void processBypassed(juce::AudioBuffer<float>& buffer); // Compressor look-ahead delay only
     void reset();
     
     //==============================================================================
@@ -31,6 +39,21 @@ public:
     void setReverbSize(float size);            // 0.0 to 1.0
     void setReverbDamping(float damping);      // 0.0 to 1.0
     void setReverbWidth(float width);          // 0.0 to 1.0
+    void setReverbPreDelay(float preDelayMs);  // 0 to 250 ms
+    
+    enum ReverbMode
+    {
+        reverbModeAlgorithmic = 0,  // FDN
+        reverbModeConvolution,      // Loaded impulse response (FDN until one is ready)
+        numReverbModes
+    };
+    
+    void setReverbMode(int mode);
+    
+    // Message thread: the file is decoded, resampled and transformed in the
+    // background, then swapped in without blocking processBlock
+    void loadReverbImpulseResponse(const juce::File& file);
+    bool hasReverbImpulseResponse() const;
     
     //==============================================================================
     // Delay Controls
@@ -39,6 +62,41 @@ public:
     void setDelayMix(float mix);               // 0.0 to 1.0
     void setDelayFilter(float cutoff);         // 20 to 20000 Hz
     
+    // Tempo Sync: the delay follows the host tempo in note divisions
+    enum DelayDivision
+    {
+        divisionHalf = 0,
+        divisionQuarter,
+        divisionQuarterDotted,
+        divisionQuarterTriplet,
+        divisionEighth,
+        divisionEighthDotted,
+        divisionEighthTriplet,
+        divisionSixteenth,
+        numDelayDivisions
+    };
+    
+    static constexpr double minSyncTempo = 40.0;  // Slowest tempo the delay buffer is sized for
+    static constexpr double maxSyncTempo = 300.0;
+    
+    void setDelaySync(bool shouldSync);
+    void setDelayDivision(int division);       // DelayDivision
+    void setHostTempo(double bpm);             // Read from the play head once per block
+    
+    static float getDivisionBeats(int division);
+    
+    // Stereo routing of the delay repeats
+    enum DelayMode
+    {
+        delayModeNormal = 0,    // Each channel repeats into itself
+        delayModePingPong,      // Mono input bounces between left and right
+        delayModeWide,          // Cross-feedback rotation with a trailing right tap
+        numDelayModes
+    };
+    
+    void setDelayMode(int mode);
+    float getEffectiveDelayTime() const;       // ms, synced or free
+    
     //==============================================================================
     // Harmony Controls
     void setHarmonyAmount(float amount);       // 0.0 to 1.0
@@ -51,16 +109,36 @@ public:
     void setDoublingAmount(float amount);      // 0.0 to 1.0
     void setDoublingDelay(float delayMs);      // 0 to 100 ms
     void setDoublingDetune(float detune);      // -50 to +50 cents
+    void setDoublingTaps(int taps);            // 2 to 6
     
     //==============================================================================
-    // Formant Controls
-    void setFormantShift(float shift);         // -1.0 to +1.0
-    void setFormantAmount(float amount);       // 0.0 to 1.0
+    // Compressor Controls
+    void setCompressorThreshold(float thresholdDb);   // -60 to 0 dB
+    void setCompressorRatio(float ratio);             // 1 to 20
+    void setCompressorKnee(float kneeDb);             // 0 to 24 dB
+    void setCompressorMakeup(float makeupDb);         // -12 to +24 dB
+    void setCompressorLookAhead(float lookAheadMs);   // 0 to 10 ms, reported as latency
+    void setCompressorStereoLink(bool shouldLink);
     
-    // Advanced Audio Processing
-    void applyNaturalPitchVariation(float* samples, int numSamples, float amount);
-    void applyDynamicEQ(float* samples, int numSamples, double sampleRate);
-    void applyVocalEnhancement(float* samples, int numSamples, double sampleRate);
+    // Dynamic EQ band (0 to DynamicEQ::numBands - 1); gain and range both 0 dB leave it flat
+    void setDynamicEQBand(int band, float frequencyHz, float gainDb, float thresholdDb, float rangeDb);
+    
+    int getLatencySamples() const { return compressor.getLatencySamples(); }
+    double getTailLengthSeconds() const;  // Longest of the reverb and delay tails
+    
+    void setHarmonyMidiMode(bool shouldUseMidi);  // Held MIDI notes choose the voices
+    void setHarmonyMidiDelay(int delaySamples);  // Latency of the audio ahead of the harmony
+    
+    // Shared per-channel analysis from the pitch tuner (Hz, 0 = unvoiced)
+    void setHarmonySourcePitch(int channel, float frequency);
+    bool needsHarmonySourcePitch() const noexcept { return harmonyMidiMode || (harmonyAmount > 0.0f && harmonyVoices > 1); }
+    
+    // Optional per-stage timing (owned by the plugin)
+    void setProfiler(StageProfiler* profilerToUse) { profiler = profilerToUse; }
+    
+    // Advanced Audio Processing (state is kept per channel)
+    void applyDynamicEQ(int channel, float* samples, int numSamples);
+    void applyCompression(juce::AudioBuffer<float>& buffer); // All channels at once for the stereo link
     
     //==============================================================================
     // Effect Parameters
@@ -68,23 +146,35 @@ public:
     float reverbSize = 0.5f;
     float reverbDamping = 0.5f;
     float reverbWidth = 1.0f;
+    float reverbPreDelay = 20.0f;
+    int reverbMode = reverbModeAlgorithmic;
     
     float delayTime = 250.0f;
     float delayFeedback = 0.3f;
     float delayMix = 0.5f;
     float delayFilter = 8000.0f;
+    bool delaySync = false;
+    int delayDivision = divisionEighth;
+    double hostTempo = 120.0;
+    int delayMode = delayModeNormal;
     
     float harmonyAmount = 0.0f;
     int harmonyVoices = 2;
     int harmonyInterval = 3; // Minor third
     float harmonyDetune = 0.0f;
+    bool harmonyMidiMode = false;
     
     float doublingAmount = 0.0f;
     float doublingDelay = 20.0f;
     float doublingDetune = 5.0f;
+    int doublingTaps = 4;
     
-    float formantShift = 0.0f;
-    float formantAmount = 0.0f;
+    float compressorThreshold = -10.0f;
+    float compressorRatio = 3.0f;
+    float compressorKnee = 6.0f;
+    float compressorMakeup = 0.0f;
+    float compressorLookAhead = 0.0f;
+    bool compressorStereoLink = true;
 
 private:
     //==============================================================================
@@ -93,227 +183,805 @@ private:
     int blockSize = 512;
     int numChannels = 2;
     bool isPrepared = false;
+    StageProfiler* profiler = nullptr;
     
     //==============================================================================
     // Reverb Processing
-    juce::dsp::Reverb reverb;
-    juce::dsp::Reverb::Parameters reverbParams;
+    FDNReverb reverb;
+    
+    // Uniform block-size partitions for the head, larger ones for the tail
+    static constexpr int convolutionHeadSize = 1024;
+    juce::dsp::Convolution convolutionReverb { juce::dsp::Convolution::NonUniform { convolutionHeadSize } };
+    
+    // Dry/wet blend; the mixer ramps its proportion over 50 ms
+    static constexpr double reverbMixRampSeconds = 0.05;
     juce::dsp::DryWetMixer<float> reverbMixer;
+    int reverbMixRampSamples = 0;
+    int reverbMixRampRemaining = 0;
     
     //==============================================================================
     // Delay Processing
-    struct DelayLine
+    // One ring per channel (SoA), both channels advanced together a frame at a
+    // time. The feedback of each channel is routed through a 2x2 matrix:
+    // identity for normal, a swap for ping-pong, a 45 degree rotation for wide.
+    struct DelayNetwork
     {
-        std::vector<float> buffer;
-        int writePosition = 0;
-        int bufferSize = 0;
+        static constexpr int maxChannels = 2;
+        static constexpr int maxChunkSize = 256;
+        static constexpr float wideOffsetMs = 20.0f;    // Right repeats trail the left in wide mode
+        
+        std::array<FractionalDelayLine, maxChannels> rings;
+        std::array<float, maxChannels> filterStates {};
+        juce::LinearSmoothedValue<float> delaySmoother;  // In samples, glides per sample
+        std::vector<float> delays;                        // Per-sample delay for the current chunk, per channel
+        std::vector<float> delayed;
+        int numChannels = 0;
         
-        void prepare(int size)
+        void prepare(int channels, int maxDelaySamples, double sampleRate)
         {
-            bufferSize = size;
-            buffer.resize(bufferSize, 0.0f);
-            writePosition = 0;
+            numChannels = juce::jlimit(1, maxChannels, channels);
+            
+            // Room for the wide-mode offset on top of the longest delay
+            const int wideOffset = static_cast<int>(std::ceil(wideOffsetMs * 0.001 * sampleRate));
+            for (auto& ring : rings)
+                ring.prepare(maxDelaySamples + wideOffset);
+            
+            delays.resize(maxChannels * maxChunkSize);
+            delayed.resize(maxChannels * maxChunkSize);
+            
+            // Delay changes glide like tape instead of jumping a block at a time
+            delaySmoother.reset(sampleRate, 0.05);
+            reset();
         }
         
-        void process(float* samples, int numSamples, float delayTime, float feedback, float mix, float filterCutoff, double sampleRate)
+        void reset()
         {
-            const float delaySamples = delayTime * 0.001f * static_cast<float>(sampleRate); // Convert ms to samples
-            int readPosition = (writePosition - static_cast<int>(delaySamples) + bufferSize) % bufferSize;
+            for (auto& ring : rings)
+                ring.reset();
             
-            for (int i = 0; i < numSamples; ++i)
+            filterStates.fill(0.0f);
+            delaySmoother.setCurrentAndTargetValue(0.0f);
+        }
+        
+        void process(float* const* channels, int channelsToProcess, int numSamples, int mode, float delayTime,
+                     float feedback, float mix, float filterCutoff, double sampleRate)
+        {
+            const int activeChannels = juce::jmin(channelsToProcess, numChannels);
+            if (activeChannels <= 0) return;
+            
+            // Modes need a pair; a mono bus always runs as a plain feedback delay
+            const bool stereo = activeChannels == maxChannels;
+            const int routing = stereo ? mode : delayModeNormal;
+            
+            const float maxDelay = rings[0].getMaxDelay();
+            const float wideOffset = routing == delayModeWide ? wideOffsetMs * 0.001f * static_cast<float>(sampleRate) : 0.0f;
+            const float targetDelay = juce::jlimit(FractionalDelayLine::minDelay, maxDelay - wideOffset,
+                                                   delayTime * 0.001f * static_cast<float>(sampleRate)); // Convert ms to samples
+            // First block after a reset starts at the requested time
+            if (delaySmoother.getCurrentValue() < FractionalDelayLine::minDelay)
+                delaySmoother.setCurrentAndTargetValue(targetDelay);
+            else
+                delaySmoother.setTargetValue(targetDelay);
+            
+            // Feedback matrix [ll lr; rl rr], orthogonal so feedback gain means the same in every mode
+            float ll = 1.0f, lr = 0.0f, rl = 0.0f, rr = 1.0f;
+            if (routing == delayModePingPong)
+            {
+                ll = rr = 0.0f;
+                lr = rl = 1.0f;
+            }
+            else if (routing == delayModeWide)
             {
-                float delayedSample = buffer[readPosition];
+                const float rotation = juce::MathConstants<float>::sqrt2 * 0.5f;
+                ll = rr = rl = rotation;
+                lr = -rotation;
+            }
+            
+            const float filterCoeff = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * filterCutoff / static_cast<float>(sampleRate));
+            
+            float* delaysL = delays.data();
+            float* delaysR = delays.data() + maxChunkSize;
+            float* delayedL = delayed.data();
+            float* delayedR = delayed.data() + maxChunkSize;
+            
+            for (int offset = 0; offset < numSamples;)
+            {
+                // The feedback write must land after every read of the chunk, so
+                // the chunk may not be longer than the shortest delay in it
+                const float shortestDelay = juce::jmin(delaySmoother.getCurrentValue(), targetDelay);
+                const int chunkSize = juce::jmin(numSamples - offset, maxChunkSize,
+                                                 FractionalDelayLine::getSafeChunkLength(shortestDelay));
+                
+                for (int i = 0; i < chunkSize; ++i)
+                {
+                    delaysL[i] = delaySmoother.getNextValue();
+                    delaysR[i] = delaysL[i] + wideOffset;
+                }
+                
+                if (! stereo)
+                {
+                    processMono(channels[0] + offset, chunkSize, feedback, mix, filterCoeff);
+                    offset += chunkSize;
+                    continue;
+                }
                 
-                // Apply simple low-pass filter to delay feedback
-                static float filterState = 0.0f;
-                const float filterCoeff = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * filterCutoff / static_cast<float>(sampleRate));
-                filterState += filterCoeff * (delayedSample - filterState);
-                delayedSample = filterState;
+                rings[0].read(delaysL, delayedL, chunkSize);
+                rings[1].read(delaysR, delayedR, chunkSize);
                 
-                // Mix with input
-                float output = samples[i] + delayedSample * feedback;
+                float* left = channels[0] + offset;
+                float* right = channels[1] + offset;
+                float stateL = filterStates[0];
+                float stateR = filterStates[1];
                 
-                // Write to delay buffer
-                buffer[writePosition] = output;
+                for (int i = 0; i < chunkSize; ++i)
+                {
+                    // Apply simple low-pass filter to delay feedback
+                    stateL += filterCoeff * (delayedL[i] - stateL);
+                    stateR += filterCoeff * (delayedR[i] - stateR);
+                    
+                    const float feedbackL = (ll * stateL + lr * stateR) * feedback;
+                    const float feedbackR = (rl * stateL + rr * stateR) * feedback;
+                    
+                    // Ping-pong feeds the mono input into the left ring only
+                    float inputL = left[i];
+                    float inputR = right[i];
+                    if (routing == delayModePingPong)
+                    {
+                        inputL = 0.5f * (left[i] + right[i]);
+                        inputR = 0.0f;
+                    }
+                    
+                    // Mix with input; each ring receives input plus feedback
+                    const float outputL = inputL + feedbackL;
+                    const float outputR = inputR + feedbackR;
+                    delayedL[i] = outputL;
+                    delayedR[i] = outputR;
+                    
+                    // Apply mix
+                    left[i] = left[i] * (1.0f - mix) + outputL * mix;
+                    right[i] = right[i] * (1.0f - mix) + outputR * mix;
+                }
+                
+                filterStates[0] = stateL;
+                filterStates[1] = stateR;
                 
-                // Update positions
-                writePosition = (writePosition + 1) % bufferSize;
-                readPosition = (readPosition + 1) % bufferSize;
+                rings[0].write(delayedL, chunkSize);
+                rings[1].write(delayedR, chunkSize);
+                offset += chunkSize;
+            }
+        }
+        
+        void processMono(float* samples, int numSamples, float feedback, float mix, float filterCoeff)
+        {
+            float* delayedL = delayed.data();
+            rings[0].read(delays.data(), delayedL, numSamples);
+            
+            float state = filterStates[0];
+            
+            for (int i = 0; i < numSamples; ++i)
+            {
+                state += filterCoeff * (delayedL[i] - state);
                 
-                // Apply mix
+                const float output = samples[i] + state * feedback;
+                delayedL[i] = output;
                 samples[i] = samples[i] * (1.0f - mix) + output * mix;
             }
+            
+            filterStates[0] = state;
+            rings[0].write(delayedL, numSamples);
         }
     };
     
-    DelayLine delayLine;
+    DelayNetwork delayNetwork;
     
     //==============================================================================
     // Harmony Processing
+    // Each voice is a streaming two-grain pitch shifter reading the channel's
+    // shared input history. Voices are summed into a separate accumulator, so
+    // they never hear each other, and each costs a fixed few operations per
+    // sample regardless of block size. The only analysis is the tuner's
+    // per-channel pitch, shared by every voice: it sets the grain length so
+    // the two crossfading taps stay a whole number of periods apart.
+    //
+    // Voices come either from the interval/voices parameters or, in MIDI
+    // mode, from the held notes, switched at the exact sample of each event.
     struct HarmonyGenerator
     {
-        std::vector<float> pitchShiftBuffers[8]; // Up to 8 harmony voices
-        std::vector<float> delayBuffers[8];
-        int bufferSizes[8];
-        int writePositions[8];
+        static constexpr int maxVoices = MidiVoicePool::capacity;
+        static constexpr int maxChunkSize = 256;        // Accumulator length
+        static constexpr int windowTableSize = 1024;
+        static constexpr int maxPendingPitches = 256;   // One report per block; 256 blocks of latency
+        
+        // A pitch report waiting for the delayed audio it describes
+        struct PendingPitch
+        {
+            juce::int64 time = 0;
+            float frequency = 0.0f;
+        };
+        
+        struct ChannelState
+        {
+            std::vector<float> history;                 // Dry input only (power-of-two ring)
+            int writePosition = 0;
+            std::array<float, maxVoices> grainPhases {}; // Per voice, 0..1
+            std::array<float, maxVoices> voiceGains {};  // Ramped towards the targets
+            std::array<float, maxVoices> voiceRatios {}; // Kept while a released voice fades
+            float grainSamples = 0.0f;                  // Gliding towards targetGrainSamples
+            float targetGrainSamples = 0.0f;
+            float sourcePitch = 0.0f;                   // Last voiced pitch (Hz), 0 until one is seen
+            
+            std::array<PendingPitch, maxPendingPitches> pendingPitches {};
+            int firstPendingPitch = 0;
+            int numPendingPitches = 0;
+        };
+        
+        // Gain and ratio each voice slot should have for the next segment
+        struct VoiceTargets
+        {
+            std::array<float, maxVoices> gains {};
+            std::array<float, maxVoices> ratios {};
+            float rootGain = 0.0f;                      // Extra copy of the dry input
+        };
+        
+        std::vector<ChannelState> channels;
+        std::vector<float> accumulator;
+        std::array<float, windowTableSize + 1> grainWindow {};
+        MidiVoicePool notePool;                         // Held notes as of the end of the last block
+        float defaultGrainSamples = 0.0f;
+        float maxGrainSamples = 0.0f;
+        float grainGlidePerSample = 0.0f;
+        float gainRampPerSample = 0.0f;
+        float sampleRate = 44100.0f;
+        int historyMask = 0;
+        
+        void prepare(int numChannels, double newSampleRate)
+        {
+            sampleRate = static_cast<float>(newSampleRate);
+            
+            // Unvoiced: 40 ms grains span several periods of even a low voice
+            defaultGrainSamples = sampleRate * 0.04f;
+            maxGrainSamples = sampleRate * 0.05f;
+            grainGlidePerSample = 1.0f / (sampleRate * 0.03f);
+            gainRampPerSample = 1.0f / (sampleRate * 0.005f); // 5 ms full-scale voice fades
+            
+            // Oldest tap plus one chunk written ahead of it
+            const int historySize = juce::nextPowerOfTwo(static_cast<int>(maxGrainSamples) + maxChunkSize + 4);
+            historyMask = historySize - 1;
+            
+            channels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+            for (auto& state : channels)
+                state.history.resize(static_cast<size_t>(historySize));
+            
+            accumulator.resize(maxChunkSize);
+            
+            // sin^2 grain window: two taps half a grain apart sum to unity gain
+            for (int i = 0; i <= windowTableSize; ++i)
+            {
+                const float s = std::sin(juce::MathConstants<float>::pi * i / windowTableSize);
+                grainWindow[static_cast<size_t>(i)] = s * s;
+            }
+            
+            reset();
+        }
+        
+        void reset()
+        {
+            for (auto& state : channels)
+            {
+                std::fill(state.history.begin(), state.history.end(), 0.0f);
+                state.writePosition = 0;
+                state.grainPhases.fill(0.0f);
+                state.voiceGains.fill(0.0f);
+                state.voiceRatios.fill(1.0f);
+                state.grainSamples = defaultGrainSamples;
+                state.targetGrainSamples = defaultGrainSamples;
+                state.sourcePitch = 0.0f;
+                state.firstPendingPitch = 0;
+                state.numPendingPitches = 0;
+            }
+            
+            notePool.allNotesOff();
+            setMidiDelay(midiDelaySamples);
+        }
+        
+        // Fundamental of the channel's input in Hz, 0 when unvoiced. The
+        // tuner reports it for the newest input, so like the MIDI notes it
+        // only takes effect once the delayed audio reaches the harmony
+        void setSourcePitch(int channel, float frequency) noexcept
+        {
+            if (channel < 0 || channel >= static_cast<int>(channels.size())) return;
+            
+            auto& state = channels[static_cast<size_t>(channel)];
+            
+            if (midiDelaySamples <= 0)
+            {
+                applySourcePitch(state, frequency);
+                return;
+            }
+            
+            // Full (very small blocks): the oldest report is due soonest anyway
+            if (state.numPendingPitches == maxPendingPitches)
+            {
+                applySourcePitch(state, state.pendingPitches[static_cast<size_t>(state.firstPendingPitch)].frequency);
+                state.firstPendingPitch = (state.firstPendingPitch + 1) % maxPendingPitches;
+                --state.numPendingPitches;
+            }
+            
+            const int slot = (state.firstPendingPitch + state.numPendingPitches) % maxPendingPitches;
+            state.pendingPitches[static_cast<size_t>(slot)] = { blockStartTime + midiDelaySamples, frequency };
+            ++state.numPendingPitches;
+        }
+        
+        void applySourcePitch(ChannelState& state, float frequency) noexcept
+        {
+            float grain = defaultGrainSamples;
+            
+            if (frequency > 0.0f)
+            {
+                // Half a grain = a whole number of periods, about 15 ms
+                const float period = sampleRate / frequency;
+                const float periodsPerHalfGrain = juce::jmax(1.0f, std::round(sampleRate * 0.015f / period));
+                grain = juce::jmin(maxGrainSamples, 2.0f * period * periodsPerHalfGrain);
+                state.sourcePitch = frequency;
+            }
+            
+            state.targetGrainSamples = grain;
+        }
         
-        void prepare(int numVoices, int bufferSize)
+        //==============================================================================
+        // Parameter mode: voices stacked at multiples of the interval
+        void process(int channel, float* samples, int numSamples, int numVoices, float amount, int interval, float detune)
         {
-            for (int i = 0; i < numVoices; ++i)
+            if (channel < 0 || channel >= static_cast<int>(channels.size())) return;
+            
+            numVoices = juce::jlimit(1, maxVoices, numVoices);
+            const float voiceGain = amount / numVoices;
+            
+            // Voice 0 is the root note
+            VoiceTargets targets;
+            targets.rootGain = voiceGain;
+            
+            for (int voice = 1; voice < numVoices; ++voice)
             {
-                pitchShiftBuffers[i].resize(bufferSize, 0.0f);
-                delayBuffers[i].resize(bufferSize, 0.0f);
-                bufferSizes[i] = bufferSize;
-                writePositions[i] = 0;
+                const float semitones = static_cast<float>(interval * voice) + detune * voice / 100.0f;
+                targets.gains[static_cast<size_t>(voice)] = voiceGain;
+                targets.ratios[static_cast<size_t>(voice)] = std::pow(2.0f, semitones / 12.0f);
             }
+            
+            renderSegment(channels[static_cast<size_t>(channel)], samples, numSamples, targets);
         }
         
-        void process(float* samples, int numSamples, int numVoices, float amount, int interval, float detune)
+        //==============================================================================
+        // MIDI mode. The harmony sees audio that is latencySamples behind the
+        // incoming MIDI (the tuner's STFT delay), so notes are queued in a
+        // fixed ring and released that much later. Pitch reports share the
+        // same clock and delay.
+        void setMidiDelay(int delaySamples)
         {
-            for (int voice = 0; voice < numVoices; ++voice)
+            midiDelaySamples = juce::jmax(0, delaySamples);
+            numPendingNotes = 0;
+            numBlockNotes = 0;
+            blockStartTime = 0;
+            
+            for (auto& state : channels)
             {
-                float voicePitchRatio = 1.0f;
+                state.firstPendingPitch = 0;
+                state.numPendingPitches = 0;
+            }
+        }
+        
+        // Once per block, before any channel: queue the new events and
+        // collect the ones that fall inside this block
+        void beginMidiBlock(const juce::MidiBuffer& midiMessages, int numSamples) noexcept
+        {
+            for (const auto metadata : midiMessages)
+            {
+                const auto message = metadata.getMessage();
+                PendingNote event { blockStartTime + metadata.samplePosition + midiDelaySamples, 0, 0.0f };
                 
-                // Calculate pitch ratio for this voice
-                if (voice == 0)
+                if (message.isNoteOn())
                 {
-                    voicePitchRatio = 1.0f; // Root note
+                    event.note = message.getNoteNumber();
+                    event.velocity = message.getFloatVelocity();
+                }
+                else if (message.isNoteOff())
+                {
+                    event.note = message.getNoteNumber();
+                }
+                else if (message.isAllNotesOff() || message.isAllSoundOff())
+                {
+                    event.note = -1;
                 }
                 else
                 {
-                    float semitones = interval * voice;
-                    float detuneCents = detune * voice;
-                    voicePitchRatio = std::pow(2.0f, (semitones + detuneCents / 100.0f) / 12.0f);
+                    continue;
                 }
                 
-                // Simple pitch shifting (in production, use more sophisticated algorithms)
-                for (int i = 0; i < numSamples; ++i)
+                // A full queue drops the event rather than grow
+                if (numPendingNotes < maxPendingNotes)
                 {
-                    float sourceIndex = i / voicePitchRatio;
-                    int sourceIndexInt = static_cast<int>(sourceIndex);
-                    float fraction = sourceIndex - sourceIndexInt;
-                    
-                    float harmonySample = 0.0f;
-                    if (sourceIndexInt >= 0 && sourceIndexInt < numSamples - 1)
-                    {
-                        harmonySample = samples[sourceIndexInt] * (1.0f - fraction) + 
-                                      samples[sourceIndexInt + 1] * fraction;
-                    }
-                    else if (sourceIndexInt >= 0 && sourceIndexInt < numSamples)
-                    {
-                        harmonySample = samples[sourceIndexInt];
-                    }
-                    
-                    // Add to output with voice-specific gain
-                    float voiceGain = amount / numVoices;
-                    samples[i] += harmonySample * voiceGain;
+                    pendingNotes[static_cast<size_t>((firstPendingNote + numPendingNotes) % maxPendingNotes)] = event;
+                    ++numPendingNotes;
+                }
+            }
+            
+            numBlockNotes = 0;
+            const juce::int64 blockEndTime = blockStartTime + numSamples;
+            
+            while (numPendingNotes > 0 && pendingNotes[static_cast<size_t>(firstPendingNote)].time < blockEndTime)
+            {
+                auto event = pendingNotes[static_cast<size_t>(firstPendingNote)];
+                event.time = juce::jmax(static_cast<juce::int64>(0), event.time - blockStartTime);
+                blockNotes[static_cast<size_t>(numBlockNotes++)] = event;
+                
+                firstPendingNote = (firstPendingNote + 1) % maxPendingNotes;
+                --numPendingNotes;
+            }
+            
+            // Pitch reports for audio inside this block, in every mode
+            for (auto& state : channels)
+            {
+                while (state.numPendingPitches > 0
+                       && state.pendingPitches[static_cast<size_t>(state.firstPendingPitch)].time < blockEndTime)
+                {
+                    applySourcePitch(state, state.pendingPitches[static_cast<size_t>(state.firstPendingPitch)].frequency);
+                    state.firstPendingPitch = (state.firstPendingPitch + 1) % maxPendingPitches;
+                    --state.numPendingPitches;
                 }
             }
+            
+            blockStartTime = blockEndTime;
+        }
+        
+        // One voice per held note, retargeted at each event's sample. Every
+        // channel replays the block from the same block-start snapshot;
+        // endMidiBlock() then advances the snapshot.
+        void processMidi(int channel, float* samples, int numSamples, float amount)
+        {
+            if (channel < 0 || channel >= static_cast<int>(channels.size())) return;
+            
+            auto& state = channels[static_cast<size_t>(channel)];
+            MidiVoicePool pool = notePool;
+            int segmentStart = 0;
+            
+            for (int i = 0; i < numBlockNotes; ++i)
+            {
+                const auto& event = blockNotes[static_cast<size_t>(i)];
+                const int eventPosition = juce::jlimit(segmentStart, numSamples, static_cast<int>(event.time));
+                
+                if (eventPosition > segmentStart)
+                {
+                    renderSegment(state, samples + segmentStart, eventPosition - segmentStart, getMidiTargets(state, pool, amount));
+                    segmentStart = eventPosition;
+                }
+                
+                applyNote(pool, event);
+            }
+            
+            if (segmentStart < numSamples)
+                renderSegment(state, samples + segmentStart, numSamples - segmentStart, getMidiTargets(state, pool, amount));
         }
-    };
-    
-    HarmonyGenerator harmonyGenerator;
-    
-    //==============================================================================
-    // Vocal Doubling Processing
-    struct VocalDoubler
-    {
-        std::vector<float> delayBuffer;
-        int writePosition = 0;
-        int bufferSize = 0;
         
-        void prepare(int size)
+        void endMidiBlock() noexcept
         {
-            bufferSize = size;
-            delayBuffer.resize(bufferSize, 0.0f);
-            writePosition = 0;
+            for (int i = 0; i < numBlockNotes; ++i)
+                applyNote(notePool, blockNotes[static_cast<size_t>(i)]);
         }
         
-        void process(float* samples, int numSamples, float amount, float delayMs, float detune, double sampleRate)
+        // Note number -1: all notes off; velocity 0: note off
+        struct PendingNote
         {
-            const float delaySamples = delayMs * 0.001f * static_cast<float>(sampleRate);
-            int readPosition = (writePosition - static_cast<int>(delaySamples) + bufferSize) % bufferSize;
+            juce::int64 time = 0;                       // Absolute while queued, block offset once due
+            int note = 0;
+            float velocity = 0.0f;
+        };
+        
+        static void applyNote(MidiVoicePool& pool, const PendingNote& event) noexcept
+        {
+            if (event.note < 0)
+                pool.allNotesOff();
+            else if (event.velocity > 0.0f)
+                pool.noteOn(event.note, event.velocity);
+            else
+                pool.noteOff(event.note);
+        }
+        
+        static constexpr int maxPendingNotes = 512;
+        std::array<PendingNote, maxPendingNotes> pendingNotes {};
+        std::array<PendingNote, maxPendingNotes> blockNotes {};
+        int firstPendingNote = 0;
+        int numPendingNotes = 0;
+        int numBlockNotes = 0;
+        juce::int64 blockStartTime = 0;
+        int midiDelaySamples = 0;
+        
+        VoiceTargets getMidiTargets(const ChannelState& state, const MidiVoicePool& pool, float amount) const
+        {
+            VoiceTargets targets;
             
-            for (int i = 0; i < numSamples; ++i)
+            // Without a pitch reference there is nothing to transpose from
+            if (state.sourcePitch <= 0.0f)
+                return targets;
+            
+            for (int slot = 0; slot < maxVoices; ++slot)
             {
-                float delayedSample = delayBuffer[readPosition];
+                const auto& voice = pool.getVoice(slot);
+                if (! voice.isActive())
+                    continue;
                 
-                // Apply slight pitch variation for doubling effect
-                if (detune != 0.0f)
+                const float noteFrequency = 440.0f * std::pow(2.0f, (voice.note - 69) / 12.0f);
+                targets.gains[static_cast<size_t>(slot)] = amount * voice.velocity;
+                targets.ratios[static_cast<size_t>(slot)] = juce::jlimit(0.25f, 4.0f, noteFrequency / state.sourcePitch);
+            }
+            
+            return targets;
+        }
+        
+        //==============================================================================
+        void renderSegment(ChannelState& state, float* samples, int numSamples, const VoiceTargets& targets)
+        {
+            // Active voices take their new ratio; released ones fade out on their last one
+            for (int voice = 0; voice < maxVoices; ++voice)
+                if (targets.gains[static_cast<size_t>(voice)] > 0.0f)
+                    state.voiceRatios[static_cast<size_t>(voice)] = targets.ratios[static_cast<size_t>(voice)];
+            
+            for (int offset = 0; offset < numSamples; offset += maxChunkSize)
+            {
+                const int chunkSize = juce::jmin(maxChunkSize, numSamples - offset);
+                float* chunk = samples + offset;
+                const int chunkStart = state.writePosition;
+                
+                // Glide the grain length so the tap delays never jump
+                const float glide = juce::jmin(1.0f, grainGlidePerSample * chunkSize);
+                state.grainSamples += (state.targetGrainSamples - state.grainSamples) * glide;
+                
+                // Record the dry input first; the voices only ever read from here
+                for (int i = 0; i < chunkSize; ++i)
+                    state.history[static_cast<size_t>((chunkStart + i) & historyMask)] = chunk[i];
+                
+                state.writePosition = (chunkStart + chunkSize) & historyMask;
+                
+                for (int i = 0; i < chunkSize; ++i)
+                    accumulator[static_cast<size_t>(i)] = chunk[i] * targets.rootGain;
+                
+                for (int voice = 0; voice < maxVoices; ++voice)
                 {
-                    float pitchRatio = 1.0f + (detune / 100.0f) * 0.01f; // Small pitch variation
-                    // Simple pitch shifting for doubling
-                    float sourceIndex = i / pitchRatio;
-                    int sourceIndexInt = static_cast<int>(sourceIndex);
-                    float fraction = sourceIndex - sourceIndexInt;
+                    const auto index = static_cast<size_t>(voice);
+                    const float startGain = state.voiceGains[index];
+                    const float targetGain = targets.gains[index];
                     
-                    if (sourceIndexInt >= 0 && sourceIndexInt < numSamples - 1)
-                    {
-                        delayedSample = delayBuffer[readPosition] * (1.0f - fraction) + 
-                                      delayBuffer[(readPosition + 1) % bufferSize] * fraction;
-                    }
+                    if (startGain <= 0.0f && targetGain <= 0.0f)
+                        continue;
+                    
+                    const float maxChange = gainRampPerSample * chunkSize;
+                    const float endGain = startGain + juce::jlimit(-maxChange, maxChange, targetGain - startGain);
+                    state.voiceGains[index] = endGain;
+                    
+                    renderVoice(state, state.grainPhases[index], state.voiceRatios[index], startGain, endGain, chunkStart, chunkSize);
                 }
                 
-                // Mix with input
-                samples[i] = samples[i] + delayedSample * amount;
+                for (int i = 0; i < chunkSize; ++i)
+                    chunk[i] += accumulator[static_cast<size_t>(i)];
+            }
+        }
+        
+        // Two read taps drift through the history at the pitch ratio while
+        // the grain phase sweeps their delay over one grain, wrapping under
+        // the other tap's crossfade.
+        void renderVoice(const ChannelState& state, float& grainPhase, float pitchRatio,
+                         float startGain, float endGain, int chunkStart, int chunkSize) noexcept
+        {
+            const float phaseIncrement = (1.0f - pitchRatio) / state.grainSamples;
+            const float gainIncrement = (endGain - startGain) / chunkSize;
+            float phase = grainPhase;
+            float gain = startGain;
+            
+            for (int i = 0; i < chunkSize; ++i)
+            {
+                const float otherPhase = phase < 0.5f ? phase + 0.5f : phase - 0.5f;
+                const int writeIndex = chunkStart + i;
                 
-                // Write to delay buffer
-                delayBuffer[writePosition] = samples[i];
+                accumulator[static_cast<size_t>(i)] += gain * (readTap(state, writeIndex, phase) * windowAt(phase)
+                                                             + readTap(state, writeIndex, otherPhase) * windowAt(otherPhase));
                 
-                // Update positions
-                writePosition = (writePosition + 1) % bufferSize;
-                readPosition = (readPosition + 1) % bufferSize;
+                phase += phaseIncrement;
+                phase -= std::floor(phase);
+                gain += gainIncrement;
             }
+            
+            grainPhase = phase;
+        }
+        
+        float readTap(const ChannelState& state, int writeIndex, float phase) const noexcept
+        {
+            // At least one sample behind the write head so interpolation stays causal
+            const float readPosition = static_cast<float>(writeIndex) - 1.0f - phase * state.grainSamples;
+            const float flooredPosition = std::floor(readPosition);
+            const int index = static_cast<int>(flooredPosition);
+            const float fraction = readPosition - flooredPosition;
+            
+            const float current = state.history[static_cast<size_t>(index & historyMask)];
+            const float next = state.history[static_cast<size_t>((index + 1) & historyMask)];
+            return current + fraction * (next - current);
+        }
+        
+        float windowAt(float phase) const noexcept
+        {
+            return grainWindow[static_cast<size_t>(phase * windowTableSize)];
         }
     };
     
-    VocalDoubler vocalDoubler;
+    HarmonyGenerator harmonyGenerator;
     
     //==============================================================================
-    // Formant Processing
-    struct FormantShifter
+    // Vocal Doubling Processing
+    // 2-6 taps read one shared history ring (the channel mix) at their own
+    // fractional delays. Each tap's delay drifts on a slow random walk whose
+    // slope is capped by the detune, so it wanders in time and pitch like a
+    // second take, and is panned to its own place. The history holds only
+    // dry input: no feedback, so no comb filtering.
+    struct VocalDoubler
     {
-        std::vector<float> formantBuffer;
-        int bufferSize = 0;
+        static constexpr int minTaps = 2;
+        static constexpr int maxTaps = 6;
+        static constexpr int maxChunkSize = 256;
+        static constexpr float minDelayMs = 5.0f;
+        static constexpr float maxWanderMs = 4.0f;       // Furthest a tap drifts from its base delay
+        static constexpr float walkIntervalMs = 60.0f;   // New random slope target this often
+        
+        struct Tap
+        {
+            float wander = 0.0f;            // Samples from the base delay
+            float slope = 0.0f;             // Samples per sample (pitch offset = -slope)
+            float targetSlope = 0.0f;
+            int samplesToNextTarget = 0;
+            float leftGain = 1.0f;
+            float rightGain = 1.0f;
+        };
+        
+        FractionalDelayLine history;
+        std::array<Tap, maxTaps> taps;
+        std::vector<float> mono;
+        std::vector<float> delays;
+        std::vector<float> tapOutput;
+        juce::Random random;
+        int pannedTaps = 0;
         
-        void prepare(int size)
+        void prepare(int maxDelaySamples)
         {
-            bufferSize = size;
-            formantBuffer.resize(bufferSize, 0.0f);
+            history.prepare(maxDelaySamples);
+            mono.resize(maxChunkSize);
+            delays.resize(maxChunkSize);
+            tapOutput.resize(maxChunkSize);
+            reset();
         }
         
-        void process(float* samples, int numSamples, float shift, float amount)
+        void reset()
         {
-            if (std::abs(shift) < 0.01f || amount < 0.01f) return;
-            
-            // Simple formant shifting using pitch shifting with different ratios
-            // In production, use more sophisticated formant preservation techniques
+            history.reset();
+            taps.fill(Tap());
+            random.setSeed(0x5eed);
+            pannedTaps = 0;
+        }
+        
+        void process(float* left, float* right, int numSamples, int numTaps, float amount,
+                     float delayMs, float detune, double sampleRate)
+        {
+            numTaps = juce::jlimit(minTaps, maxTaps, numTaps);
+            const float sr = static_cast<float>(sampleRate);
             
-            for (int i = 0; i < numSamples; ++i)
+            // Spread the taps evenly over the field, constant power
+            if (numTaps != pannedTaps)
             {
-                float formantRatio = 1.0f + shift * 0.5f; // Scale the shift
-                float sourceIndex = i / formantRatio;
-                int sourceIndexInt = static_cast<int>(sourceIndex);
-                float fraction = sourceIndex - sourceIndexInt;
-                
-                float formantSample = 0.0f;
-                if (sourceIndexInt >= 0 && sourceIndexInt < numSamples - 1)
+                for (int t = 0; t < numTaps; ++t)
                 {
-                    formantSample = samples[sourceIndexInt] * (1.0f - fraction) + 
-                                  samples[sourceIndexInt + 1] * fraction;
+                    const float pan = static_cast<float>(t) / static_cast<float>(numTaps - 1); // 0 = left, 1 = right
+                    taps[static_cast<size_t>(t)].leftGain = std::cos(pan * juce::MathConstants<float>::halfPi);
+                    taps[static_cast<size_t>(t)].rightGain = std::sin(pan * juce::MathConstants<float>::halfPi);
                 }
-                else if (sourceIndexInt >= 0 && sourceIndexInt < numSamples)
+                
+                pannedTaps = numTaps;
+            }
+            
+            // Largest drift slope a detune (cents) allows, and the tap base delays from 0.5x to 1.5x the set time
+            const float maxSlope = std::abs(std::pow(2.0f, detune / 1200.0f) - 1.0f);
+            const float maxWander = maxWanderMs * 0.001f * sr;
+            const float slopeGlide = 1.0f - std::exp(-1.0f / (0.02f * sr));
+            const int walkInterval = juce::jmax(1, static_cast<int>(walkIntervalMs * 0.001f * sr));
+            const float centreDelay = juce::jmax(minDelayMs, delayMs) * 0.001f * sr;
+            const float shortestDelay = juce::jmax(FractionalDelayLine::minDelay, 0.5f * centreDelay - maxWander);
+            const float longestDelay = history.getMaxDelay();
+            const float tapGain = amount / std::sqrt(static_cast<float>(numTaps));
+            
+            // Runs no longer than the shortest delay, so every read precedes its write
+            const int chunkLimit = juce::jmin(maxChunkSize, FractionalDelayLine::getSafeChunkLength(shortestDelay));
+            
+            for (int offset = 0; offset < numSamples;)
+            {
+                const int chunkSize = juce::jmin(chunkLimit, numSamples - offset);
+                float* chunkLeft = left + offset;
+                float* chunkRight = right != nullptr ? right + offset : nullptr;
+                
+                for (int i = 0; i < chunkSize; ++i)
+                    mono[static_cast<size_t>(i)] = chunkRight != nullptr ? 0.5f * (chunkLeft[i] + chunkRight[i]) : chunkLeft[i];
+                
+                for (int t = 0; t < numTaps; ++t)
                 {
-                    formantSample = samples[sourceIndexInt];
+                    auto& tap = taps[static_cast<size_t>(t)];
+                    const float baseDelay = centreDelay * (0.5f + static_cast<float>(t) / static_cast<float>(numTaps - 1));
+                    
+                    for (int i = 0; i < chunkSize; ++i)
+                    {
+                        // Random walk on the slope; steer back once the tap has wandered far
+                        if (--tap.samplesToNextTarget <= 0)
+                        {
+                            tap.targetSlope = maxSlope * (random.nextFloat() * 2.0f - 1.0f);
+                            if (std::abs(tap.wander) > 0.5f * maxWander)
+                                tap.targetSlope = -std::copysign(std::abs(tap.targetSlope), tap.wander);
+                            
+                            tap.samplesToNextTarget = walkInterval;
+                        }
+                        
+                        tap.slope += slopeGlide * (tap.targetSlope - tap.slope);
+                        tap.wander = juce::jlimit(-maxWander, maxWander, tap.wander + tap.slope);
+                        
+                        delays[static_cast<size_t>(i)] = juce::jlimit(shortestDelay, longestDelay, baseDelay + tap.wander);
+                    }
+                    
+                    history.read(delays.data(), tapOutput.data(), chunkSize);
+                    
+                    const float gainLeft = tapGain * (chunkRight != nullptr ? tap.leftGain : 1.0f);
+                    const float gainRight = tapGain * tap.rightGain;
+                    
+                    for (int i = 0; i < chunkSize; ++i)
+                        chunkLeft[i] += tapOutput[static_cast<size_t>(i)] * gainLeft;
+                    
+                    if (chunkRight != nullptr)
+                        for (int i = 0; i < chunkSize; ++i)
+                            chunkRight[i] += tapOutput[static_cast<size_t>(i)] * gainRight;
                 }
                 
-                // Mix with original
-                samples[i] = samples[i] * (1.0f - amount) + formantSample * amount;
+                // History gets the dry input only
+                history.write(mono.data(), chunkSize);
+                offset += chunkSize;
             }
         }
     };
     
-    FormantShifter formantShifter;
+    VocalDoubler vocalDoubler;
+    
+    //==============================================================================
+    // Dynamics (parameters are pushed on every change so the latency is current)
+    VocalCompressor compressor;
+    
+    void updateCompressorParameters();
+    
+    // Coefficients are shared; each channel keeps its own DynamicEQ::State
+    DynamicEQ dynamicEQ;
+    
+    //==============================================================================
+    // Per-channel DSP State
+    // Filter state a channel writes on its own lives here, owned by this
+    // instance (the stereo stages keep their rings themselves). Each entry
+    // starts on its own cache line, so channels and plugin instances running
+    // on different cores never share written memory.
+    struct alignas(64) ChannelState
+    {
+        DynamicEQ::State dynamicEQ;
+        
+        void resetFilters()
+        {
+            dynamicEQ = {};
+        }
+    };
+    
+    std::vector<ChannelState> channelStates;
+    
+    ChannelState* getChannelState(int channel)
+    {
+        return juce::isPositiveAndBelow(channel, static_cast<int>(channelStates.size()))
+                   ? &channelStates[static_cast<size_t>(channel)] : nullptr;
+    }
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VocalEffects)
 };